@@ -0,0 +1,409 @@
+#include "BenchmarkHarness.h"
+#include "FirstTouchBuffer.h"
+#include "JobSystem.h"
+#include "Matrix.h"
+#include "Model.h"
+#include "NumaTopology.h"
+#include "Renderer.h"
+#include "ShaderProgram.h"
+#include "TileBinner.h"
+#include "View.h"
+#include "World.h"
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Benchmarks of the renderer's hot paths, from loading to full frames. Run from the Rasterizer directory so the
+// Model/ files are found (the project's debugger working directory is set to it):
+//
+//     Benchmark --json results.json
+//
+// Results are printed as a table and, with --json, written in Google Benchmark's JSON layout so runs can be compared
+// with its compare.py or any tool that reads that format.
+
+static const char* HeadModel = "Model/head.obj";
+
+// Camera placements for the full-frame benchmarks
+struct CameraPlacement {
+    const char* name;
+    Vertex position;
+};
+
+static const CameraPlacement Cameras[] = {
+    { "Front", { 0.0f, 0.0f, 1.0f } },
+    { "Oblique", { 1.0f, 0.5f, 1.0f } },
+    { "Far", { 0.0f, 0.0f, 3.0f } },
+};
+
+// Function to run code with std::cout discarded; the loader reports what it read on every load
+template <typename Function>
+static void withoutConsole(Function function) {
+    std::ostringstream discard;
+    std::streambuf* previous = std::cout.rdbuf(discard.rdbuf());
+    function();
+    std::cout.rdbuf(previous);
+}
+
+// Function to point the camera globals at the model and rebuild the matrices
+static void placeCamera(const Vertex& position) {
+    Camera = position;
+    updateWorld();
+}
+
+// Function to set up a shader for drawing the head from the current camera into a target
+static void bindShader(PhongShader& shader, RenderTarget& target) {
+    shader.setTransforms(projection * viewMatrix, Matrix::identity(4), target.getViewport(), lightDirection);
+    shader.uniform_Material = &material;
+}
+
+// Function to register loading and the math building blocks
+static void addMathBenchmarks(BenchmarkRunner& runner) {
+    runner.add("LoadObj/head", [] {
+        withoutConsole([] {
+            Model model(HeadModel);
+            doNotOptimize(model.getFaces().size());
+        });
+    });
+
+    std::shared_ptr<Matrix> a = std::make_shared<Matrix>(lookAt(Camera, Target, Up));
+    std::shared_ptr<Matrix> b = std::make_shared<Matrix>(projection);
+    runner.add("Matrix/Multiply4x4", [a, b] {
+        Matrix product = *a * *b;
+        doNotOptimize(product);
+    });
+    runner.add("Matrix/InvertTranspose", [a] {
+        Matrix inverse = a->invertTranspose();
+        doNotOptimize(inverse);
+    });
+    runner.add("Matrix/LookAt", [] {
+        Matrix view = lookAt(Camera, Target, Up);
+        doNotOptimize(view);
+    });
+}
+
+// Function to register the per-vertex and per-fragment stages
+static void addShaderBenchmarks(BenchmarkRunner& runner, const Model& head) {
+    std::shared_ptr<RenderTarget> target = std::make_shared<RenderTarget>(1024, 1024);
+    std::shared_ptr<PhongShader> shader = std::make_shared<PhongShader>();
+    std::shared_ptr<std::vector<Vertex>> screenCoords = std::make_shared<std::vector<Vertex>>(head.getVertices().size());
+    const Model* model = &head;
+
+    runner.add("VertexTransform/head", [target, shader, screenCoords, model] {
+        placeCamera(Cameras[0].position);
+        bindShader(*shader, *target);
+        transformVertices(*model, *shader, screenCoords->data());
+        doNotOptimize(screenCoords->data());
+    }, static_cast<double>(head.getVertices().size()));
+
+    // The fragment shaders walk barycentric coordinates across a triangle with a real texture mapping
+    const int Fragments = 1024;
+    runner.add("FragmentShader/Single", [target, shader] {
+        placeCamera(Cameras[0].position);
+        bindShader(*shader, *target);
+        shader->uvCoord[0] = { 0.1f, 0.2f };
+        shader->uvCoord[1] = { 0.8f, 0.3f };
+        shader->uvCoord[2] = { 0.4f, 0.9f };
+        Color color = { 0, 0, 0, 255 };
+        for (int i = 0; i < Fragments; ++i) {
+            float s = (i % 32) / 32.0f;
+            float t = (i / 32) / 64.0f;
+            Vertex bary = { s * (1.0f - t), t, 1.0f - s * (1.0f - t) - t };
+            shader->fragmentShader(bary, color);
+            doNotOptimize(color);
+        }
+    }, Fragments);
+
+    runner.add("FragmentShader/Quad", [target, shader] {
+        placeCamera(Cameras[0].position);
+        bindShader(*shader, *target);
+        shader->uvCoord[0] = { 0.1f, 0.2f };
+        shader->uvCoord[1] = { 0.8f, 0.3f };
+        shader->uvCoord[2] = { 0.4f, 0.9f };
+        FragmentQuad quad;
+        quad.mask = 0xF;
+        Color colors[4];
+        for (int i = 0; i < Fragments; i += 4) {
+            for (int lane = 0; lane < 4; ++lane) {
+                float s = ((i + lane) % 32) / 32.0f;
+                float t = ((i + lane) / 32) / 64.0f;
+                quad.baryX[lane] = s * (1.0f - t);
+                quad.baryY[lane] = t;
+                quad.baryZ[lane] = 1.0f - quad.baryX[lane] - t;
+            }
+            doNotOptimize(shader->fragmentShaderQuad(quad, colors));
+        }
+    }, Fragments);
+}
+
+// Function to register texture fetches at scattered coordinates, so most of them miss the cache as on a real model
+static void addTextureBenchmarks(BenchmarkRunner& runner) {
+    const int Samples = 4096;
+    std::shared_ptr<std::vector<TexCoord>> coords = std::make_shared<std::vector<TexCoord>>(Samples);
+    uint32_t state = 12345;
+    for (TexCoord& coord : *coords) {
+        state = state * 1664525u + 1013904223u;
+        coord.u = (state >> 8) / 16777216.0f;
+        state = state * 1664525u + 1013904223u;
+        coord.v = (state >> 8) / 16777216.0f;
+    }
+
+    runner.add("TextureSample/Nearest", [coords] {
+        for (const TexCoord& coord : *coords) {
+            doNotOptimize(material.sample(coord.u, coord.v));
+        }
+    }, Samples);
+
+#ifdef RASTERIZER_SSE
+    runner.add("TextureSample/Nearest4", [coords] {
+        const TexCoord* coord = coords->data();
+        for (int i = 0; i < Samples; i += 4) {
+            __m128 u = _mm_setr_ps(coord[i].u, coord[i + 1].u, coord[i + 2].u, coord[i + 3].u);
+            __m128 v = _mm_setr_ps(coord[i].v, coord[i + 1].v, coord[i + 2].v, coord[i + 3].v);
+            __m128i albedoSpecular;
+            __m128i normal;
+            material.sample4(u, v, albedoSpecular, normal);
+            doNotOptimize(albedoSpecular);
+            doNotOptimize(normal);
+        }
+    }, Samples);
+#endif
+}
+
+// Function to register single triangles of different shapes. Each iteration clears the target first, which only
+// marks its tiles; the tiles the triangle touches are then cleared lazily, as in a frame.
+static void addTriangleBenchmarks(BenchmarkRunner& runner) {
+    struct TriangleShape {
+        const char* name;
+        Vertex corners[3];
+    };
+    static const TriangleShape Shapes[] = {
+        { "Small", { { 100.0f, 100.0f, 0.5f }, { 108.0f, 100.0f, 0.5f }, { 100.0f, 108.0f, 0.5f } } },
+        { "Large", { { 0.0f, 0.0f, 0.5f }, { 511.0f, 0.0f, 0.5f }, { 0.0f, 511.0f, 0.5f } } },
+        { "Thin", { { 4.0f, 10.0f, 0.5f }, { 508.0f, 500.0f, 0.5f }, { 506.0f, 502.0f, 0.5f } } },
+    };
+
+    for (const TriangleShape& shape : Shapes) {
+        std::shared_ptr<RenderTarget> target = std::make_shared<RenderTarget>(512, 512);
+        std::shared_ptr<PhongShader> shader = std::make_shared<PhongShader>();
+        const TriangleShape* triangle = &shape;
+
+        runner.add(std::string("RenderTriangle/") + shape.name, [target, shader, triangle] {
+            placeCamera(Cameras[0].position);
+            bindShader(*shader, *target);
+            shader->uvCoord[0] = { 0.1f, 0.2f };
+            shader->uvCoord[1] = { 0.8f, 0.3f };
+            shader->uvCoord[2] = { 0.4f, 0.9f };
+            Vertex corners[3] = { triangle->corners[0], triangle->corners[1], triangle->corners[2] };
+            target->clear({ 0, 0, 0, 255 });
+            renderTriangle(corners, *shader, *target);
+            doNotOptimize(target->getColorData());
+        });
+    }
+}
+
+// Function to register full frames of the head: clear, draw and resolve, as the viewer renders them. Each frame runs
+// twice: with the raster loop specialized for PhongShader, and as /Virtual through the shaderProgram interface, which
+// calls every shader stage virtually.
+static void addFrameBenchmarks(BenchmarkRunner& runner, const Model& head) {
+    const int Resolutions[] = { 256, 512, 1024, 2048 };
+    const Model* model = &head;
+
+    for (int resolution : Resolutions) {
+        for (const CameraPlacement& camera : Cameras) {
+            std::shared_ptr<RenderTarget> target = std::make_shared<RenderTarget>(resolution, resolution);
+            std::shared_ptr<PhongShader> shader = std::make_shared<PhongShader>();
+            const CameraPlacement* placement = &camera;
+
+            const std::string name = "RenderModel/" + std::to_string(resolution) + "/" + camera.name;
+
+            runner.add(name, [target, shader, model, placement] {
+                placeCamera(placement->position);
+                target->clear({ 0, 0, 0, 255 });
+                renderModel(*model, *shader, *target);
+                target->resolve();
+                doNotOptimize(target->getColorData());
+            }, static_cast<double>(resolution) * resolution);
+
+            runner.add(name + "/Virtual", [target, shader, model, placement] {
+                placeCamera(placement->position);
+                target->clear({ 0, 0, 0, 255 });
+                renderModel(*model, static_cast<shaderProgram&>(*shader), *target);
+                target->resolve();
+                doNotOptimize(target->getColorData());
+            }, static_cast<double>(resolution) * resolution);
+        }
+    }
+}
+
+// Function to register a turntable of 32 views of the head at 256x256 rendered as one batch, on one thread and on every
+// hardware thread. Items are views, so Items/s is the batch throughput.
+static void addMultiViewBenchmarks(BenchmarkRunner& runner, const Model& head) {
+    const int ViewCount = 32;
+    const int Resolution = 256;
+    const Model* model = &head;
+
+    std::shared_ptr<std::vector<View>> views = std::make_shared<std::vector<View>>(
+        makeTurntableViews({ 1.0f, 0.5f, 1.0f }, Target, Up, lightDirection, ViewCount));
+    std::vector<int> threadCounts = { 1 };
+    if (std::thread::hardware_concurrency() > 1) {
+        threadCounts.push_back(static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    for (int threads : threadCounts) {
+        std::shared_ptr<JobSystem> jobs = std::make_shared<JobSystem>(threads);
+        std::shared_ptr<std::vector<RenderTarget>> targets = std::make_shared<std::vector<RenderTarget>>();
+        for (int i = 0; i < ViewCount; ++i) {
+            targets->emplace_back(Resolution, Resolution);
+        }
+        std::shared_ptr<PhongShader> shader = std::make_shared<PhongShader>();
+        runner.add("MultiView/" + std::to_string(ViewCount) + "x" + std::to_string(Resolution) + "/" + std::to_string(threads) +
+            "threads", [model, views, targets, shader, jobs] {
+            renderViews(*model, material, *views, *shader, { 0, 0, 0, 255 }, *targets, *jobs);
+            doNotOptimize(targets->back().getColorData());
+        }, static_cast<double>(ViewCount));
+    }
+}
+
+// Function to register binning of a million-triangle frame: small triangles scattered over a 1920x1080 target, as a
+// dense mesh produces them, on one thread and on every hardware thread. The arena is reset like a frame resets it.
+static void addBinningBenchmarks(BenchmarkRunner& runner) {
+    const int Width = 1920;
+    const int Height = 1080;
+    const size_t TriangleCount = 1 << 20;
+
+    std::shared_ptr<std::vector<BinnedTriangle>> triangles = std::make_shared<std::vector<BinnedTriangle>>(TriangleCount);
+    uint32_t seed = 12345;
+    auto random = [&seed](int range) {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<int>((seed >> 8) % static_cast<uint32_t>(range));
+    };
+    for (BinnedTriangle& triangle : *triangles) {
+        // Mostly a few pixels across; one in 64 spans several tiles
+        int size = random(64) == 0 ? 40 + random(200) : 2 + random(12);
+        int x = random(Width - size);
+        int y = random(Height - size);
+        triangle = BinnedTriangle();
+        triangle.bounds = { x, y, x + size, y + size };
+    }
+
+    std::vector<int> threadCounts = { 1 };
+    if (std::thread::hardware_concurrency() > 1) {
+        threadCounts.push_back(static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    for (int threads : threadCounts) {
+        std::shared_ptr<FrameArena> arena = std::make_shared<FrameArena>();
+        std::shared_ptr<TileBinner> binner = std::make_shared<TileBinner>();
+        std::shared_ptr<JobSystem> jobs = std::make_shared<JobSystem>(threads);
+        runner.add("Binning/1M/" + std::to_string(threads) + "threads", [triangles, arena, binner, jobs] {
+            arena->reset();
+            binner->bin(triangles->data(), triangles->size(), Width, Height, *jobs, *arena);
+            doNotOptimize(binner->getEntryCount());
+        }, static_cast<double>(TriangleCount));
+    }
+}
+
+// Function to register the job system's scheduling cost: a parallelFor over a million indices, split into 1K-index
+// jobs that each do a few nanoseconds of work per index, on one thread and on every hardware thread
+static void addJobSystemBenchmarks(BenchmarkRunner& runner) {
+    const size_t Count = 1 << 20;
+    const size_t Grain = 1024;
+
+    std::vector<int> threadCounts = { 1 };
+    if (std::thread::hardware_concurrency() > 1) {
+        threadCounts.push_back(static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    for (int threads : threadCounts) {
+        std::shared_ptr<JobSystem> jobs = std::make_shared<JobSystem>(threads);
+        std::shared_ptr<std::vector<uint32_t>> values = std::make_shared<std::vector<uint32_t>>(Count);
+        runner.add("ParallelFor/1M/" + std::to_string(threads) + "threads", [jobs, values] {
+            uint32_t* data = values->data();
+            jobs->parallelFor(Count, Grain, [data](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    data[i] = data[i] * 1664525u + 1013904223u;
+                }
+            });
+            doNotOptimize(data[0]);
+        }, static_cast<double>(Count));
+    }
+}
+
+// Function to register the memory bandwidth between every pair of NUMA nodes: one thread bound to a node's CPUs
+// streams through a 32 MB buffer that a thread of another (or the same) node first touched. Items are bytes, so the
+// Items/s column is the read bandwidth; the diagonal is each node's local bandwidth. Simulated nodes
+// (RASTERIZER_NUMA_NODES) only move the threads, so their figures stay alike.
+static void addNumaBenchmarks(BenchmarkRunner& runner) {
+    const size_t Count = (32 << 20) / sizeof(uint64_t);
+    const NumaTopology& topology = NumaTopology::instance();
+
+    std::shared_ptr<std::vector<int>> allCpus = std::make_shared<std::vector<int>>();
+    for (int node = 0; node < topology.getNodeCount(); ++node) {
+        allCpus->insert(allCpus->end(), topology.getCpus(node).begin(), topology.getCpus(node).end());
+    }
+
+    for (int memoryNode = 0; memoryNode < topology.getNodeCount(); ++memoryNode) {
+        std::shared_ptr<FirstTouchBuffer<uint64_t>> buffer = std::make_shared<FirstTouchBuffer<uint64_t>>();
+        buffer->allocate(Count);
+        std::thread toucher([buffer, &topology, memoryNode] {
+            NumaTopology::bindCurrentThread(topology.getCpus(memoryNode));
+            for (size_t i = 0; i < Count; ++i) {
+                (*buffer)[i] = i;
+            }
+        });
+        toucher.join();
+
+        for (int cpuNode = 0; cpuNode < topology.getNodeCount(); ++cpuNode) {
+            std::shared_ptr<const std::vector<int>> cpus = std::make_shared<std::vector<int>>(topology.getCpus(cpuNode));
+            std::string name = "NumaRead/cpu" + std::to_string(cpuNode) + "/mem" + std::to_string(memoryNode);
+            runner.add(name, [buffer, cpus, allCpus] {
+                NumaTopology::bindCurrentThread(*cpus);
+                const uint64_t* data = buffer->data();
+                uint64_t sum = 0;
+                for (size_t i = 0; i < Count; ++i) {
+                    sum += data[i];
+                }
+                doNotOptimize(sum);
+                NumaTopology::bindCurrentThread(*allCpus);
+            }, static_cast<double>(Count * sizeof(uint64_t)));
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkRunner runner(argc, argv);
+    if (!runner.ok())
+    {
+        return 1;
+    }
+
+    if (!material.loadFromFiles("Model/head.tga", "Model/head_nm.tga", "Model/head_spec.tga"))
+    {
+        printf("Error: run the benchmark from the Rasterizer directory so Model/ can be found\n");
+        return 1;
+    }
+
+    std::unique_ptr<Model> head;
+    withoutConsole([&head] { head.reset(new Model(HeadModel)); });
+    if (head->getFaces().empty())
+    {
+        printf("Error: %s has no faces\n", HeadModel);
+        return 1;
+    }
+
+    addMathBenchmarks(runner);
+    addShaderBenchmarks(runner, *head);
+    addTextureBenchmarks(runner);
+    addTriangleBenchmarks(runner);
+    addBinningBenchmarks(runner);
+    addJobSystemBenchmarks(runner);
+    addNumaBenchmarks(runner);
+    addFrameBenchmarks(runner, *head);
+    addMultiViewBenchmarks(runner, *head);
+
+    int status = runner.run();
+    withoutConsole([&head] { head.reset(); });
+    return status;
+}
@@ -0,0 +1,245 @@
+#include "BenchmarkHarness.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+// Constructor: Defaults give stable numbers for frame-sized work in a few seconds per benchmark
+BenchmarkRunner::BenchmarkRunner(int argc, char** argv) : valid(true) {
+    options.minBatchSeconds = 0.2;
+    options.repetitions = 5;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+            options.filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--json") == 0 && hasValue) {
+            options.jsonPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--min-time") == 0 && hasValue) {
+            options.minBatchSeconds = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--repetitions") == 0 && hasValue) {
+            options.repetitions = std::max(1, atoi(argv[++i]));
+        }
+        else {
+            printf("Error: unknown argument %s\n", argv[i]);
+            printf("Usage: %s [--filter text] [--json file] [--min-time seconds] [--repetitions count]\n", argv[0]);
+            valid = false;
+        }
+    }
+}
+
+bool BenchmarkRunner::ok() const {
+    return valid;
+}
+
+void BenchmarkRunner::add(const std::string& name, std::function<void()> body, double itemsPerIteration) {
+    benchmarks.push_back({ name, std::move(body), itemsPerIteration });
+}
+
+const std::vector<BenchmarkResult>& BenchmarkRunner::getResults() const {
+    return results;
+}
+
+// Function to time a batch of iterations, in wall and process CPU nanoseconds
+static void timeBatch(const std::function<void()>& body, uint64_t iterations, double& realNs, double& cpuNs) {
+    std::clock_t cpuStart = std::clock();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; ++i) {
+        body();
+    }
+    realNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    cpuNs = (std::clock() - cpuStart) * (1e9 / CLOCKS_PER_SEC);
+}
+
+// Function to calibrate the batch size, then time the batches
+BenchmarkResult BenchmarkRunner::measure(const Benchmark& benchmark) {
+    BenchmarkResult result;
+    result.name = benchmark.name;
+    result.itemsPerIteration = benchmark.itemsPerIteration;
+
+    // Grow the batch until it runs long enough to time reliably; the first runs also warm caches
+    const double minNs = options.minBatchSeconds * 1e9;
+    uint64_t iterations = 1;
+    double realNs = 0.0;
+    double cpuNs = 0.0;
+    for (;;) {
+        timeBatch(benchmark.body, iterations, realNs, cpuNs);
+        if (realNs >= minNs || iterations >= 1000000000) {
+            break;
+        }
+        double scale = realNs > 0.0 ? minNs * 1.4 / realNs : 10.0;
+        iterations = static_cast<uint64_t>(iterations * std::min(10.0, std::max(2.0, scale)));
+    }
+    result.iterations = iterations;
+
+    for (int i = 0; i < options.repetitions; ++i) {
+        timeBatch(benchmark.body, iterations, realNs, cpuNs);
+        result.realNs.push_back(realNs / iterations);
+        result.cpuNs.push_back(cpuNs / iterations);
+    }
+
+    std::vector<double> sorted = result.realNs;
+    std::sort(sorted.begin(), sorted.end());
+    size_t count = sorted.size();
+    result.minNs = sorted[0];
+    result.medianNs = count % 2 ? sorted[count / 2] : 0.5 * (sorted[count / 2 - 1] + sorted[count / 2]);
+
+    double sum = 0.0;
+    for (double value : sorted) {
+        sum += value;
+    }
+    result.meanNs = sum / count;
+
+    double squares = 0.0;
+    for (double value : sorted) {
+        squares += (value - result.meanNs) * (value - result.meanNs);
+    }
+    result.stddevNs = count > 1 ? std::sqrt(squares / (count - 1)) : 0.0;
+    return result;
+}
+
+// Function to pick a readable unit for a time in nanoseconds
+static void printTime(double ns) {
+    if (ns >= 1e6) {
+        printf("%10.3f ms", ns * 1e-6);
+    }
+    else if (ns >= 1e3) {
+        printf("%10.3f us", ns * 1e-3);
+    }
+    else {
+        printf("%10.1f ns", ns);
+    }
+}
+
+// Function to run the matching benchmarks in registration order
+int BenchmarkRunner::run() {
+    printf("%-44s %13s %13s %13s %12s %14s\n", "Benchmark", "Median", "Min", "Stddev", "Iterations", "Items/s");
+    for (const Benchmark& benchmark : benchmarks) {
+        if (!options.filter.empty() && benchmark.name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+
+        BenchmarkResult result = measure(benchmark);
+        printf("%-44s ", result.name.c_str());
+        printTime(result.medianNs);
+        printf(" ");
+        printTime(result.minNs);
+        printf(" ");
+        printTime(result.stddevNs);
+        printf(" %12llu", static_cast<unsigned long long>(result.iterations));
+        if (result.itemsPerIteration > 0.0) {
+            printf(" %14.4g", result.itemsPerIteration * 1e9 / result.medianNs);
+        }
+        printf("\n");
+        fflush(stdout);
+        results.push_back(result);
+    }
+
+    if (!options.jsonPath.empty() && !writeJson(options.jsonPath)) {
+        return 1;
+    }
+    return 0;
+}
+
+// Function to write one entry of the benchmarks array
+static void writeEntry(FILE* file, const BenchmarkResult& result, const char* aggregate, double realNs,
+    double cpuNs, bool last) {
+    fprintf(file, "    {\n");
+    fprintf(file, "      \"name\": \"%s%s%s\",\n", result.name.c_str(), aggregate ? "_" : "", aggregate ? aggregate : "");
+    fprintf(file, "      \"run_name\": \"%s\",\n", result.name.c_str());
+    fprintf(file, "      \"run_type\": \"%s\",\n", aggregate ? "aggregate" : "iteration");
+    fprintf(file, "      \"repetitions\": %zu,\n", result.realNs.size());
+    if (aggregate) {
+        fprintf(file, "      \"aggregate_name\": \"%s\",\n", aggregate);
+    }
+    fprintf(file, "      \"iterations\": %llu,\n", static_cast<unsigned long long>(result.iterations));
+    fprintf(file, "      \"real_time\": %.6g,\n", realNs);
+    fprintf(file, "      \"cpu_time\": %.6g,\n", cpuNs);
+    // A throughput of the standard deviation means nothing, so it is left out there
+    bool throughput = result.itemsPerIteration > 0.0 && realNs > 0.0 && (aggregate == nullptr || strcmp(aggregate, "stddev") != 0);
+    if (throughput) {
+        fprintf(file, "      \"time_unit\": \"ns\",\n");
+        fprintf(file, "      \"items_per_second\": %.6g\n", result.itemsPerIteration * 1e9 / realNs);
+    }
+    else {
+        fprintf(file, "      \"time_unit\": \"ns\"\n");
+    }
+    fprintf(file, "    }%s\n", last ? "" : ",");
+}
+
+// Function to write the report: every timed batch, then mean, median and stddev per benchmark as Google Benchmark
+// does with --benchmark_repetitions
+bool BenchmarkRunner::writeJson(const std::string& path) const {
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        printf("Error: can't open benchmark output %s\n", path.c_str());
+        return false;
+    }
+
+    char date[64];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+#if defined(_MSC_VER)
+    const char* compiler = "msvc";
+#elif defined(__clang__)
+    const char* compiler = "clang";
+#elif defined(__GNUC__)
+    const char* compiler = "gcc";
+#else
+    const char* compiler = "unknown";
+#endif
+
+#ifdef NDEBUG
+    const char* buildType = "release";
+#else
+    const char* buildType = "debug";
+#endif
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"context\": {\n");
+    fprintf(file, "    \"date\": \"%s\",\n", date);
+    fprintf(file, "    \"num_cpus\": %u,\n", std::thread::hardware_concurrency());
+    fprintf(file, "    \"compiler\": \"%s\",\n", compiler);
+    fprintf(file, "    \"library_build_type\": \"%s\",\n", buildType);
+    fprintf(file, "    \"min_time\": %.6g\n", options.minBatchSeconds);
+    fprintf(file, "  },\n");
+    fprintf(file, "  \"benchmarks\": [\n");
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& result = results[i];
+        for (size_t batch = 0; batch < result.realNs.size(); ++batch) {
+            writeEntry(file, result, nullptr, result.realNs[batch], result.cpuNs[batch], false);
+        }
+
+        std::vector<double> cpuSorted = result.cpuNs;
+        std::sort(cpuSorted.begin(), cpuSorted.end());
+        double cpuMean = 0.0;
+        for (double value : cpuSorted) {
+            cpuMean += value / cpuSorted.size();
+        }
+        size_t count = cpuSorted.size();
+        double cpuMedian = count % 2 ? cpuSorted[count / 2] : 0.5 * (cpuSorted[count / 2 - 1] + cpuSorted[count / 2]);
+
+        writeEntry(file, result, "mean", result.meanNs, cpuMean, false);
+        writeEntry(file, result, "median", result.medianNs, cpuMedian, false);
+        writeEntry(file, result, "stddev", result.stddevNs, 0.0, i + 1 == results.size());
+    }
+
+    fprintf(file, "  ]\n");
+    fprintf(file, "}\n");
+
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    if (ok) {
+        printf("Results written to %s\n", path.c_str());
+    }
+    return ok;
+}
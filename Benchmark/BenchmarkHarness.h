@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Minimal micro-benchmark runner. Each benchmark is a function run once per iteration; the runner first finds an
+// iteration count that takes at least the minimum batch time, then times several batches and reports statistics of
+// the per-iteration time. Results are written as JSON in the layout Google Benchmark uses, so its compare tools and
+// dashboards can read them.
+
+// Options of one run, usually parsed from the command line
+struct BenchmarkOptions {
+    std::string filter;        // Only benchmarks whose name contains this run; empty runs all
+    std::string jsonPath;      // Where to write the JSON report; empty skips it
+    double minBatchSeconds;    // Each timed batch runs at least this long
+    int repetitions;           // Number of timed batches
+};
+
+// Statistics of one benchmark
+struct BenchmarkResult {
+    std::string name;
+    uint64_t iterations;          // Iterations per timed batch
+    std::vector<double> realNs;   // Wall time per iteration of each batch
+    std::vector<double> cpuNs;    // Process CPU time per iteration of each batch
+    double meanNs;                // Statistics of realNs
+    double medianNs;
+    double minNs;
+    double stddevNs;
+    double itemsPerIteration;     // Work per iteration (triangles, pixels, ...), or 0 when not declared
+};
+
+class BenchmarkRunner {
+public:
+    // Constructor: parses --filter, --json, --min-time (seconds) and --repetitions; ok() is false on bad arguments
+    BenchmarkRunner(int argc, char** argv);
+
+    // True when the command line was valid
+    bool ok() const;
+
+    // Register a benchmark. itemsPerIteration (triangles, pixels, ...) adds a throughput figure.
+    void add(const std::string& name, std::function<void()> body, double itemsPerIteration = 0.0);
+
+    // Run every registered benchmark that matches the filter, print a table and write the JSON report
+    int run();
+
+    const std::vector<BenchmarkResult>& getResults() const;
+
+private:
+    struct Benchmark {
+        std::string name;
+        std::function<void()> body;
+        double itemsPerIteration;
+    };
+
+    // Time one benchmark
+    BenchmarkResult measure(const Benchmark& benchmark);
+
+    // Write the results with the machine and build description
+    bool writeJson(const std::string& path) const;
+
+    BenchmarkOptions options;
+    bool valid;
+    std::vector<Benchmark> benchmarks;
+    std::vector<BenchmarkResult> results;
+};
+
+// Keep a value alive so the computation producing it is not optimized away
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile char sink;
+    sink = *reinterpret_cast<const volatile char*>(&value);
+    _ReadWriteBarrier();
+#endif
+}
@@ -0,0 +1,247 @@
+#include "JobSystem.h"
+#include "Model.h"
+#include "Renderer.h"
+#include "ShaderProgram.h"
+#include "TiledRenderer.h"
+#include "TraceRecorder.h"
+#include "View.h"
+#include "World.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Render the example model into an image file without a window, for render nodes and scripted comparisons.
+// Run from the Rasterizer directory so the Model/ files are found:
+//
+//     RasterizerHeadless --width 1000 --height 1000 --camera 1 0.5 1 --output head.tga
+//
+// --views n renders a turntable of n views around the model in one parallel batch and writes head_000.tga onwards.
+
+// Everything the command line selects
+struct HeadlessOptions {
+    int width;
+    int height;
+    int frames;              // Frames rendered; the last one is written
+    Vertex camera;
+    Vertex light;
+    bool fastMath;           // ShaderQuality::Fast instead of the reference math
+    int threads;             // Job threads rendering tile by tile; 0 draws immediately. The image is the same either way.
+    int pinFirstCore;        // Pin job workers to the CPUs after this one (see JobSystem); -1 leaves them unpinned
+    int views;               // Turntable views rendered as one batch; 0 renders the single camera
+    std::string modelFile;
+    std::string outputFile;
+    std::string traceFile;   // Chrome trace of the run; empty records nothing
+};
+
+// Function to read three floats following an option
+static bool parseVertex(int argc, char** argv, int& i, Vertex& vertex)
+{
+    if (i + 3 >= argc)
+    {
+        return false;
+    }
+    vertex.x = static_cast<float>(atof(argv[++i]));
+    vertex.y = static_cast<float>(atof(argv[++i]));
+    vertex.z = static_cast<float>(atof(argv[++i]));
+    return true;
+}
+
+// Function to parse the command line; returns false and prints the usage on bad arguments
+static bool parseOptions(int argc, char** argv, HeadlessOptions& options)
+{
+    options.width = 1000;
+    options.height = 1000;
+    options.frames = 1;
+    options.camera = Camera;
+    options.light = lightDirection;
+    options.fastMath = false;
+    options.threads = 0;
+    options.pinFirstCore = -1;
+    options.views = 0;
+    options.modelFile = "Model/head.obj";
+    options.outputFile = "head.tga";
+
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        bool ok = true;
+        if (strcmp(argv[i], "--width") == 0 && hasValue)
+            options.width = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--height") == 0 && hasValue)
+            options.height = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--frames") == 0 && hasValue)
+            options.frames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--camera") == 0)
+            ok = parseVertex(argc, argv, i, options.camera);
+        else if (strcmp(argv[i], "--light") == 0)
+            ok = parseVertex(argc, argv, i, options.light);
+        else if (strcmp(argv[i], "--fast") == 0)
+            options.fastMath = true;
+        else if (strcmp(argv[i], "--threads") == 0 && hasValue)
+            options.threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--pin") == 0 && hasValue)
+            options.pinFirstCore = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--views") == 0 && hasValue)
+            options.views = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--model") == 0 && hasValue)
+            options.modelFile = argv[++i];
+        else if (strcmp(argv[i], "--output") == 0 && hasValue)
+            options.outputFile = argv[++i];
+        else if (strcmp(argv[i], "--trace") == 0 && hasValue)
+            options.traceFile = argv[++i];
+        else
+            ok = false;
+
+        if (!ok)
+        {
+            printf("Error: bad argument %s\n", argv[i]);
+            printf("Usage: %s [--width w] [--height h] [--frames n] [--camera x y z] [--light x y z] [--fast]\n"
+                "       [--threads n] [--pin first-cpu] [--views n] [--model file.obj] [--output file.tga]\n"
+                "       [--trace trace.json]\n", argv[0]);
+            return false;
+        }
+    }
+
+    if (options.width <= 0 || options.height <= 0 || options.frames <= 0 || options.threads < 0 || options.views < 0)
+    {
+        printf("Error: size and frame count must be positive, thread and view counts not negative\n");
+        return false;
+    }
+    return true;
+}
+
+// Function to name the file of one turntable view: the output name with the view number before the extension
+static std::string viewFileName(const std::string& outputFile, int view)
+{
+    char number[16];
+    snprintf(number, sizeof(number), "_%03d", view);
+    size_t dot = outputFile.find_last_of('.');
+    if (dot == std::string::npos)
+    {
+        return outputFile + number;
+    }
+    return outputFile.substr(0, dot) + number + outputFile.substr(dot);
+}
+
+// Function to render the turntable views as batches and write one image per view; returns the exit code
+static int renderTurntable(const HeadlessOptions& options, const Model& model, const PhongShader& shader)
+{
+    std::vector<View> views = makeTurntableViews(options.camera, Target, Up, options.light, options.views);
+    std::vector<RenderTarget> targets;
+    for (int i = 0; i < options.views; ++i)
+    {
+        targets.emplace_back(options.width, options.height);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < options.frames; ++frame)
+    {
+        TRACE_SCOPE("Render batch");
+        renderViews(model, material, views, shader, { 0, 0, 0, 255 }, targets);
+    }
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("Rendered %d batch(es) of %d %dx%d views in %.3f ms per batch, %.1f views/s\n", options.frames, options.views,
+        options.width, options.height, elapsedMs / options.frames, options.views * options.frames * 1000.0 / elapsedMs);
+
+    for (int i = 0; i < options.views; ++i)
+    {
+        std::string fileName = viewFileName(options.outputFile, i);
+        if (!targets[i].writeTGA(fileName.c_str()))
+        {
+            printf("Error: can't write %s\n", fileName.c_str());
+            return 1;
+        }
+    }
+    printf("Images written to %s onwards\n", viewFileName(options.outputFile, 0).c_str());
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    HeadlessOptions options;
+    if (!parseOptions(argc, argv, options))
+    {
+        return 1;
+    }
+
+    if (!options.traceFile.empty())
+    {
+#ifndef RASTERIZER_TRACE
+        printf("Warning: built without RASTERIZER_TRACE, so %s will hold no scopes\n", options.traceFile.c_str());
+#endif
+        TraceRecorder::instance().setEnabled(true);
+    }
+    TRACE_THREAD_NAME("Main");
+
+    // Loading uses the job system too, so it is configured first
+    if (options.threads > 0 || options.pinFirstCore >= 0)
+    {
+        JobSystem::instance().configure(options.threads, options.pinFirstCore >= 0, std::max(options.pinFirstCore, 0));
+    }
+
+    if (!material.loadFromFiles("Model/head.tga", "Model/head_nm.tga", "Model/head_spec.tga"))
+    {
+        return 1;
+    }
+
+    Model model(options.modelFile);
+    if (model.getFaces().empty())
+    {
+        printf("Error: %s has no faces\n", options.modelFile.c_str());
+        return 1;
+    }
+
+    Camera = options.camera;
+    lightDirection = options.light;
+    updateWorld();
+
+    PhongShader shader;
+    shader.quality = options.fastMath ? ShaderQuality::Fast : ShaderQuality::Reference;
+    if (options.views > 0)
+    {
+        int status = renderTurntable(options, model, shader);
+        if (status == 0 && !options.traceFile.empty() && !TraceRecorder::instance().writeChromeTrace(options.traceFile))
+        {
+            return 1;
+        }
+        return status;
+    }
+    RenderTarget target(options.width, options.height);
+
+    Scene scene;
+    scene.addInstance(scene.addMesh(model), scene.addMaterial(material), Matrix::identity(4));
+    TiledRenderer<PhongShader> tiles;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < options.frames; ++frame)
+    {
+        TRACE_SCOPE("Render frame");
+        target.clear({ 0, 0, 0, 255 });
+        if (options.threads > 0)
+            tiles.render(scene, currentView(), shader, target);
+        else
+            renderModel(model, shader, target);
+        target.resolve();
+    }
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("Rendered %d frame(s) of %dx%d in %.3f ms per frame\n", options.frames, options.width, options.height,
+        elapsedMs / options.frames);
+
+    if (!target.writeTGA(options.outputFile.c_str()))
+    {
+        printf("Error: can't write %s\n", options.outputFile.c_str());
+        return 1;
+    }
+    printf("Image written to %s\n", options.outputFile.c_str());
+
+    if (!options.traceFile.empty() && !TraceRecorder::instance().writeChromeTrace(options.traceFile))
+    {
+        return 1;
+    }
+    return 0;
+}
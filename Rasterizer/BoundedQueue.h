@@ -0,0 +1,79 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Blocking first-in first-out queue with a fixed capacity, used to hand work between threads.
+// push() waits while the queue is full and pop() waits while it is empty, so a fast producer
+// can never run more than `capacity` items ahead of its consumer. Items live in a ring allocated up front,
+// so pushing and popping never allocate.
+template <typename T>
+class BoundedQueue {
+public:
+    // Constructor: the queue holds at most capacity items
+    explicit BoundedQueue(size_t capacity);
+
+    // Add an item, waiting for space; returns false if the queue was closed
+    bool push(T item);
+
+    // Take the oldest item, waiting for one; returns false once the queue is closed and empty
+    bool pop(T& item);
+
+    // Wake every waiter; later pushes fail and pops drain what is left
+    void close();
+
+private:
+    size_t capacity;                  // Maximum number of queued items
+    bool closed;                      // Set by close()
+    std::vector<T> items;             // Ring of capacity slots
+    size_t head;                      // Slot of the oldest item
+    size_t count;                     // Queued items
+    std::mutex mutex;                 // Guards every member above
+    std::condition_variable notEmpty; // Signalled after a push
+    std::condition_variable notFull;  // Signalled after a pop
+};
+
+template <typename T>
+inline BoundedQueue<T>::BoundedQueue(size_t capacity) : capacity(capacity), closed(false), items(capacity), head(0), count(0) {
+}
+
+template <typename T>
+inline bool BoundedQueue<T>::push(T item) {
+    std::unique_lock<std::mutex> lock(mutex);
+    notFull.wait(lock, [this] { return closed || count < capacity; });
+    if (closed) {
+        return false;
+    }
+    items[(head + count) % capacity] = std::move(item);
+    count++;
+    lock.unlock();
+    notEmpty.notify_one();
+    return true;
+}
+
+template <typename T>
+inline bool BoundedQueue<T>::pop(T& item) {
+    std::unique_lock<std::mutex> lock(mutex);
+    notEmpty.wait(lock, [this] { return closed || count > 0; });
+    if (count == 0) {
+        return false;
+    }
+    item = std::move(items[head]);
+    head = (head + 1) % capacity;
+    count--;
+    lock.unlock();
+    notFull.notify_one();
+    return true;
+}
+
+template <typename T>
+inline void BoundedQueue<T>::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+    }
+    notEmpty.notify_all();
+    notFull.notify_all();
+}
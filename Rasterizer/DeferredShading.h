@@ -0,0 +1,153 @@
+#pragma once
+
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "RenderCommandBuffer.h"
+#include "RenderTarget.h"
+#include "ShaderProgram.h"
+#include "TraceRecorder.h"
+#include "View.h"
+#include <algorithm>
+#include <vector>
+
+// Re-run the fragment shader over a frame that was rendered with the visibility attachment enabled, without touching
+// geometry. Each pixel is shaded again with the uniforms of the draw that produced it, rebuilt from the commands and
+// the view, so only what the fragment shader reads may differ from the rendered frame: the light direction, the
+// shader's quality setting. The commands, the camera and the target size must be the ones the frame was rendered with,
+// and the target must have been resolved. Shader replaces the shader of every command.
+template <typename Shader>
+void reshadeVisibility(const RenderCommandBuffer& commands, const View& view, const Shader& shader, RenderTarget& target,
+    JobSystem& jobs = JobSystem::instance());
+
+// Rows per re-shade job; even, so every job shades whole quads
+const int ReshadeJobRows = 16;
+
+// Re-shade rows [rowBegin, rowEnd) of a target (rowBegin even) with one prepared shader per draw id
+template <typename Shader>
+void reshadeRows(const std::vector<Shader>& drawShaders, RenderTarget& target, int rowBegin, int rowEnd);
+
+// Function to rebuild the per-draw uniforms and shade bands of rows in parallel
+template <typename Shader>
+void reshadeVisibility(const RenderCommandBuffer& commands, const View& view, const Shader& shader, RenderTarget& target,
+    JobSystem& jobs)
+{
+    static_assert(isCopyableShader<Shader>, "Shader is copied by value, so it must be a final shader type such as PhongShader, not the shaderProgram interface");
+    if (target.getVisibilityData() == nullptr || target.getHeight() <= 0)
+    {
+        return;
+    }
+
+    // The visible texture coordinates are stored already interpolated, so the shaders interpolate with unit weights:
+    // barycentrics (u, v, 1 - u - v) against these corners give back exactly (u, v)
+    const TexCoord passThrough[3] = { { 1.0f, 0.0f }, { 0.0f, 1.0f }, { 0.0f, 0.0f } };
+
+    Matrix viewProjection = view.projection * view.viewMatrix;
+    Matrix viewportTransform = target.getViewport();
+    // Kept between calls, so re-shading a steady scene doesn't allocate. Jobs reach it through the reference;
+    // naming the thread_local in their lambda would give each worker its own empty vector.
+    static thread_local std::vector<Shader> scratchShaders;
+    std::vector<Shader>& drawShaders = scratchShaders;
+    drawShaders.assign(commands.size(), shader);
+    for (size_t i = 0; i < commands.size(); ++i)
+    {
+        const RenderCommand& command = commands.getCommand(i);
+        drawShaders[i].setTransforms(viewProjection, command.modelMatrix, viewportTransform, view.lightDirection);
+        drawShaders[i].uniform_Material = command.material;
+        std::copy(passThrough, passThrough + 3, drawShaders[i].uvCoord);
+    }
+
+    // Pixels are independent, so bands of rows (whole quads tall) shade as separate jobs
+    const int height = target.getHeight();
+    const size_t bandCount = (height + ReshadeJobRows - 1) / ReshadeJobRows;
+    jobs.parallelFor(bandCount, 1, [&drawShaders, &target, height](size_t begin, size_t end)
+    {
+        int rowBegin = static_cast<int>(begin) * ReshadeJobRows;
+        int rowEnd = std::min(static_cast<int>(end) * ReshadeJobRows, height);
+        reshadeRows(drawShaders, target, rowBegin, rowEnd);
+    });
+}
+
+// Function to shade the visible samples of some rows, one 2x2 quad at a time
+template <typename Shader>
+void reshadeRows(const std::vector<Shader>& drawShaders, RenderTarget& target, int rowBegin, int rowEnd)
+{
+    PROFILE_SCOPE(ProfileStage::FragmentShading);
+    TRACE_SCOPE("Shade");
+    const VisibilitySample* visibility = target.getVisibilityData();
+    const int width = target.getWidth();
+    const int stride = target.getStride();
+    const int laneX[4] = { 0, 1, 0, 1 };
+    const int laneY[4] = { 0, 0, 1, 1 };
+
+    // Each draw gets its own copy only while shading, since the fragment shader is not const
+    Shader drawShader = drawShaders.empty() ? Shader() : drawShaders[0];
+    uint32_t loadedDraw = VisibilitySample::NoDraw;
+
+    FragmentQuad quad;
+    Color colors[4] = { { 255, 255, 255, 255 }, { 255, 255, 255, 255 }, { 255, 255, 255, 255 }, { 255, 255, 255, 255 } };
+    uint32_t laneDraw[4];
+    int offset[4] = {};
+
+    for (int y = rowBegin; y < rowEnd; y += 2)
+    {
+        for (int x = 0; x < width; x += 2)
+        {
+            // Gather the covered lanes of the quad
+            int pending = 0;
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                int px = x + laneX[lane];
+                int py = y + laneY[lane];
+                laneDraw[lane] = VisibilitySample::NoDraw;
+                if (px < width && py < rowEnd)
+                {
+                    offset[lane] = py * stride + px;
+                    const VisibilitySample& sample = visibility[offset[lane]];
+                    if (sample.draw < drawShaders.size())
+                    {
+                        laneDraw[lane] = sample.draw;
+                        quad.baryX[lane] = sample.u;
+                        quad.baryY[lane] = sample.v;
+                        quad.baryZ[lane] = 1.0f - sample.u - sample.v;
+                        pending |= 1 << lane;
+                    }
+                }
+            }
+
+            // Lanes from different draws are shaded in separate passes over the quad, each with its draw's uniforms
+            while (pending)
+            {
+                int firstLane = 0;
+                while (!(pending & (1 << firstLane)))
+                {
+                    ++firstLane;
+                }
+                uint32_t draw = laneDraw[firstLane];
+
+                quad.mask = 0;
+                for (int lane = firstLane; lane < 4; ++lane)
+                {
+                    if ((pending & (1 << lane)) && laneDraw[lane] == draw)
+                    {
+                        quad.mask |= 1 << lane;
+                    }
+                }
+                pending &= ~quad.mask;
+
+                if (draw != loadedDraw)
+                {
+                    drawShader = drawShaders[draw];
+                    loadedDraw = draw;
+                }
+                int written = drawShader.fragmentShaderQuad(quad, colors);
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    if (written & quad.mask & (1 << lane))
+                    {
+                        target.setPixel(offset[lane], colors[lane]);
+                    }
+                }
+            }
+        }
+    }
+}
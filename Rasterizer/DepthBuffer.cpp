@@ -0,0 +1,68 @@
+#include "DepthBuffer.h"
+
+// Constructor: Allocates the buffer and clears it to the far plane
+DepthBuffer::DepthBuffer(int width, int height, DepthFormat format, bool reversedZ)
+    : width(width), height(height), format(format), func(DepthFunc::Less), reversedZ(reversedZ), tiles(width, height) {
+    configure(format, reversedZ);
+}
+
+// Function to switch the storage format and depth convention
+void DepthBuffer::configure(DepthFormat newFormat, bool newReversedZ) {
+    format = newFormat;
+    reversedZ = newReversedZ;
+    func = reversedZ ? DepthFunc::Greater : DepthFunc::Less;
+
+    // Only the active format keeps its storage. Every tile is stale after the reset, so nothing is written here and
+    // the first clear of each tile places its pages
+    size_t size = static_cast<size_t>(width) * height;
+    depth32f.allocate(format == DepthFormat::Float32 ? size : 0);
+    depth24.allocate(format == DepthFormat::Unorm24 ? size : 0);
+    depth16.allocate(format == DepthFormat::Unorm16 ? size : 0);
+    tiles.reset(width, height);
+}
+
+// Function to override the depth comparison
+void DepthBuffer::setDepthFunc(DepthFunc newFunc) {
+    func = newFunc;
+}
+
+// Function to reset the buffer to the far plane; tiles are refilled lazily when a draw first touches them
+void DepthBuffer::clear() {
+    tiles.clear();
+}
+
+// Function to fill one rectangle of the active storage with the far plane value
+void DepthBuffer::fillFarPlane(int x0, int y0, int x1, int y1) {
+    float farPlane = reversedZ ? 0.0f : 1.0f;
+    for (int y = y0; y <= y1; ++y) {
+        size_t begin = static_cast<size_t>(y) * width + x0;
+        size_t end = begin + (x1 - x0 + 1);
+        switch (format) {
+        case DepthFormat::Float32:
+            std::fill(depth32f.data() + begin, depth32f.data() + end, encode<DepthFormat::Float32>(farPlane));
+            break;
+        case DepthFormat::Unorm24:
+            std::fill(depth24.data() + begin, depth24.data() + end, encode<DepthFormat::Unorm24>(farPlane));
+            break;
+        case DepthFormat::Unorm16:
+            std::fill(depth16.data() + begin, depth16.data() + end, encode<DepthFormat::Unorm16>(farPlane));
+            break;
+        }
+    }
+}
+
+// Function to read back a depth value as a float in [0, 1]; untouched tiles read as the far plane
+float DepthBuffer::read(int index) const {
+    if (!tiles.isCurrent(index % width, index / width)) {
+        return reversedZ ? 0.0f : 1.0f;
+    }
+
+    switch (format) {
+    case DepthFormat::Unorm24:
+        return depth24[index] / 16777215.0f;
+    case DepthFormat::Unorm16:
+        return depth16[index] / 65535.0f;
+    default:
+        return depth32f[index];
+    }
+}
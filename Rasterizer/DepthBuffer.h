@@ -0,0 +1,176 @@
+#pragma once
+
+#include "FirstTouchBuffer.h"
+#include "TileClearState.h"
+#include <algorithm>
+#include <cstdint>
+
+// Storage format of the depth values
+enum class DepthFormat {
+    Float32, // 32-bit float
+    Unorm24, // 24-bit normalized integer stored in 32 bits
+    Unorm16  // 16-bit normalized integer, half the bandwidth of the 32-bit formats
+};
+
+// Comparison between an incoming depth and the stored one; the fragment passes when it holds
+enum class DepthFunc {
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    Always
+};
+
+// Depth buffer with a configurable format and depth convention.
+// Conventional depth stores 0 at the near plane and 1 at the far plane and tests with Less;
+// reversed-Z stores 1 at the near plane and 0 at the far plane and tests with Greater.
+class DepthBuffer {
+public:
+    // Constructor: allocates a buffer of the given size, cleared to the far plane
+    DepthBuffer(int width, int height, DepthFormat format = DepthFormat::Float32, bool reversedZ = false);
+
+    // Change format and convention; resets the depth function to the convention's default and clears
+    void configure(DepthFormat format, bool reversedZ);
+
+    // Override the depth function
+    void setDepthFunc(DepthFunc func);
+
+    // Reset every value to the far plane. Only marks the tiles stale; see prepare()
+    void clear();
+
+    // Initialize the stale tiles overlapping a pixel rectangle (inclusive, inside the buffer).
+    // Must be called before test/write touch pixels in that rectangle.
+    void prepare(int minX, int minY, int maxX, int maxY);
+
+    // Convert a screen-space depth (1/w, in [0, 1] with larger nearer) to this buffer's depth convention
+    float toDepth(float screenZ) const;
+
+    // Depth test of a fragment against the stored value at a pixel index
+    template <DepthFormat Format>
+    bool test(int index, float depth) const;
+
+    // Store a fragment's depth at a pixel index
+    template <DepthFormat Format>
+    void write(int index, float depth);
+
+    // Decoded depth at a pixel index, in [0, 1]
+    float read(int index) const;
+
+    int getWidth() const;
+
+    int getHeight() const;
+
+    DepthFormat getFormat() const;
+
+    DepthFunc getDepthFunc() const;
+
+    bool isReversedZ() const;
+
+private:
+    // Quantize a depth in [0, 1] to the storage type of the format
+    template <DepthFormat Format>
+    static auto encode(float depth);
+
+    // Compare two encoded depths using the active function
+    template <typename T>
+    bool compare(T incoming, T stored) const;
+
+    // Fill a pixel rectangle (inclusive) with the far plane value
+    void fillFarPlane(int x0, int y0, int x1, int y1);
+
+    int width;                     // Buffer width in pixels
+    int height;                    // Buffer height in pixels
+    DepthFormat format;            // Active storage format
+    DepthFunc func;                // Active depth function
+    bool reversedZ;                // True when 1 is the near plane
+    FirstTouchBuffer<float> depth32f;   // Storage for Float32
+    FirstTouchBuffer<uint32_t> depth24; // Storage for Unorm24
+    FirstTouchBuffer<uint16_t> depth16; // Storage for Unorm16
+    TileClearState tiles;          // Tiles initialized since the last clear
+};
+
+template <DepthFormat Format>
+inline auto DepthBuffer::encode(float depth) {
+    depth = std::min(std::max(depth, 0.0f), 1.0f);
+    if constexpr (Format == DepthFormat::Float32) {
+        return depth;
+    }
+    else if constexpr (Format == DepthFormat::Unorm24) {
+        return static_cast<uint32_t>(depth * 16777215.0f + 0.5f);
+    }
+    else {
+        return static_cast<uint16_t>(depth * 65535.0f + 0.5f);
+    }
+}
+
+template <typename T>
+inline bool DepthBuffer::compare(T incoming, T stored) const {
+    switch (func) {
+    case DepthFunc::Less:
+        return incoming < stored;
+    case DepthFunc::LessEqual:
+        return incoming <= stored;
+    case DepthFunc::Greater:
+        return incoming > stored;
+    case DepthFunc::GreaterEqual:
+        return incoming >= stored;
+    default:
+        return true;
+    }
+}
+
+template <DepthFormat Format>
+inline bool DepthBuffer::test(int index, float depth) const {
+    if constexpr (Format == DepthFormat::Float32) {
+        return compare(encode<Format>(depth), depth32f[index]);
+    }
+    else if constexpr (Format == DepthFormat::Unorm24) {
+        return compare(encode<Format>(depth), depth24[index]);
+    }
+    else {
+        return compare(encode<Format>(depth), depth16[index]);
+    }
+}
+
+template <DepthFormat Format>
+inline void DepthBuffer::write(int index, float depth) {
+    if constexpr (Format == DepthFormat::Float32) {
+        depth32f[index] = encode<Format>(depth);
+    }
+    else if constexpr (Format == DepthFormat::Unorm24) {
+        depth24[index] = encode<Format>(depth);
+    }
+    else {
+        depth16[index] = encode<Format>(depth);
+    }
+}
+
+inline void DepthBuffer::prepare(int minX, int minY, int maxX, int maxY) {
+    tiles.touch(minX, minY, maxX, maxY, [this](int x0, int y0, int x1, int y1) {
+        fillFarPlane(x0, y0, x1, y1);
+    });
+}
+
+inline float DepthBuffer::toDepth(float screenZ) const {
+    return reversedZ ? screenZ : 1.0f - screenZ;
+}
+
+inline int DepthBuffer::getWidth() const {
+    return width;
+}
+
+inline int DepthBuffer::getHeight() const {
+    return height;
+}
+
+inline DepthFormat DepthBuffer::getFormat() const {
+    return format;
+}
+
+inline DepthFunc DepthBuffer::getDepthFunc() const {
+    return func;
+}
+
+inline bool DepthBuffer::isReversedZ() const {
+    return reversedZ;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+// Fixed-size array whose elements are left uninitialized when it is allocated. Nothing writes the memory until its
+// owner does, so the operating system places each page on the NUMA node of the thread that first writes it (first
+// touch) instead of on the node of the thread that allocated the buffer. Render targets initialize their tiles lazily
+// (see TileClearState), so the thread that first clears a tile decides where that tile's rows live.
+//
+// Buffers move but don't copy: a copy would read elements nobody has written yet and touch every page from the copying
+// thread, undoing the placement.
+template <typename T>
+class FirstTouchBuffer {
+    static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+        "FirstTouchBuffer holds plain values only");
+
+public:
+    // Constructor: an empty buffer
+    FirstTouchBuffer();
+
+    FirstTouchBuffer(const FirstTouchBuffer&) = delete;
+
+    FirstTouchBuffer(FirstTouchBuffer&& other) noexcept = default;
+
+    FirstTouchBuffer& operator=(const FirstTouchBuffer&) = delete;
+
+    FirstTouchBuffer& operator=(FirstTouchBuffer&& other) noexcept = default;
+
+    // Replace the contents by count uninitialized elements
+    void allocate(size_t count);
+
+    // Replace the contents by count copies of value; the calling thread touches every page
+    void assign(size_t count, const T& value);
+
+    // Free the storage
+    void release();
+
+    size_t size() const;
+
+    T* data();
+
+    const T* data() const;
+
+    T& operator[](size_t index);
+
+    const T& operator[](size_t index) const;
+
+private:
+    std::unique_ptr<T[]> elements; // Storage, default-initialized so it is never written on allocation
+    size_t count;                  // Number of elements
+};
+
+template <typename T>
+inline FirstTouchBuffer<T>::FirstTouchBuffer() : count(0) {
+}
+
+template <typename T>
+inline void FirstTouchBuffer<T>::allocate(size_t newCount) {
+    elements.reset(newCount > 0 ? new T[newCount] : nullptr);
+    count = newCount;
+}
+
+template <typename T>
+inline void FirstTouchBuffer<T>::assign(size_t newCount, const T& value) {
+    allocate(newCount);
+    std::fill(data(), data() + count, value);
+}
+
+template <typename T>
+inline void FirstTouchBuffer<T>::release() {
+    elements.reset();
+    count = 0;
+}
+
+template <typename T>
+inline size_t FirstTouchBuffer<T>::size() const {
+    return count;
+}
+
+template <typename T>
+inline T* FirstTouchBuffer<T>::data() {
+    return elements.get();
+}
+
+template <typename T>
+inline const T* FirstTouchBuffer<T>::data() const {
+    return elements.get();
+}
+
+template <typename T>
+inline T& FirstTouchBuffer<T>::operator[](size_t index) {
+    return elements[index];
+}
+
+template <typename T>
+inline const T& FirstTouchBuffer<T>::operator[](size_t index) const {
+    return elements[index];
+}
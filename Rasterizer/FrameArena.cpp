@@ -0,0 +1,48 @@
+#include "FrameArena.h"
+#include <algorithm>
+
+// Constructor: Nothing is allocated unless a first block size is given
+FrameArena::FrameArena(size_t initialBytes) : current(0), offset(0), used(0), peak(0) {
+    if (initialBytes > 0) {
+        addBlock(initialBytes, 1);
+    }
+}
+
+// Function to start a new block when the current one is full. Blocks added during a frame grow geometrically, so a
+// frame needs few of them even when its size jumps.
+void FrameArena::addBlock(size_t bytes, size_t alignment) {
+    size_t previous = blocks.empty() ? 0 : blocks.back().size;
+    Block block;
+    block.size = std::max({ bytes + alignment, previous * 2, static_cast<size_t>(64 * 1024) });
+    block.memory.reset(new unsigned char[block.size]);
+    blocks.push_back(std::move(block));
+    current = blocks.size() - 1;
+    offset = 0;
+}
+
+// Function to release the frame's allocations. Spilled frames are merged into one block sized for the whole frame.
+void FrameArena::reset() {
+    peak = std::max(peak, used);
+    if (blocks.size() > 1) {
+        size_t total = 0;
+        for (const Block& block : blocks) {
+            total += block.size;
+        }
+        blocks.clear();
+        Block block;
+        block.memory.reset(new unsigned char[total]);
+        block.size = total;
+        blocks.push_back(std::move(block));
+    }
+    current = 0;
+    offset = 0;
+    used = 0;
+}
+
+size_t FrameArena::getCapacity() const {
+    size_t total = 0;
+    for (const Block& block : blocks) {
+        total += block.size;
+    }
+    return total;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Linear allocator for data that lives for one frame: allocating bumps an offset, and reset() releases everything at
+// once. Nothing is freed or destroyed individually, so only trivially destructible types may be allocated.
+//
+// When a frame needs more than the current block, a further block is added; the next reset() replaces the blocks by
+// one block large enough for the whole frame. A steady workload therefore stops allocating from the heap after its
+// first frames. Not thread-safe: allocate on one thread, then hand disjoint ranges to workers.
+class FrameArena {
+public:
+    // Constructor: optionally reserve a first block
+    explicit FrameArena(size_t initialBytes = 0);
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Uninitialized memory for count objects of T, valid until the next reset
+    template <typename T>
+    T* allocate(size_t count);
+
+    // Uninitialized memory of a size and power-of-two alignment, valid until the next reset
+    void* allocateBytes(size_t bytes, size_t alignment);
+
+    // Release everything allocated since the last reset, merging the blocks if the frame overflowed the first one
+    void reset();
+
+    // Bytes allocated since the last reset, including alignment padding
+    size_t getUsedBytes() const;
+
+    // Most bytes any frame used so far
+    size_t getPeakBytes() const;
+
+    // Bytes held in blocks
+    size_t getCapacity() const;
+
+private:
+    // One contiguous allocation
+    struct Block {
+        std::unique_ptr<unsigned char[]> memory;
+        size_t size;
+    };
+
+    // Add a block with room for at least bytes at the given alignment
+    void addBlock(size_t bytes, size_t alignment);
+
+    std::vector<Block> blocks; // Blocks in the order they were added
+    size_t current;            // Block being allocated from
+    size_t offset;             // Next free byte in the current block
+    size_t used;               // Bytes handed out since the last reset, over all blocks
+    size_t peak;               // Largest used seen at a reset
+};
+
+template <typename T>
+inline T* FrameArena::allocate(size_t count) {
+    static_assert(std::is_trivially_destructible<T>::value, "FrameArena never runs destructors");
+    return static_cast<T*>(allocateBytes(count * sizeof(T), alignof(T)));
+}
+
+inline void* FrameArena::allocateBytes(size_t bytes, size_t alignment) {
+    if (current < blocks.size()) {
+        Block& block = blocks[current];
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.memory.get());
+        size_t aligned = ((base + offset + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1)) - base;
+        if (aligned + bytes <= block.size) {
+            used += aligned + bytes - offset;
+            offset = aligned + bytes;
+            return block.memory.get() + aligned;
+        }
+    }
+    addBlock(bytes, alignment);
+    return allocateBytes(bytes, alignment);
+}
+
+inline size_t FrameArena::getUsedBytes() const {
+    return used;
+}
+
+inline size_t FrameArena::getPeakBytes() const {
+    return peak > used ? peak : used;
+}
@@ -0,0 +1,289 @@
+#pragma once
+
+#include "BoundedQueue.h"
+#include "JobSystem.h"
+#include "RenderCommandBuffer.h"
+#include "RenderTarget.h"
+#include "Renderer.h"
+#include "Scene.h"
+#include "TiledRenderer.h"
+#include "TraceRecorder.h"
+#include "View.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Stages a frame goes through, each on its own thread
+enum class PipelineStage {
+    Geometry, // Sort the draws, run the vertex transform and set up triangles
+    Binning,  // Sort triangles into screen tiles, keeping primitive order
+    Raster,   // Clear the target and rasterize tile by tile
+    Present,  // Hand the finished image to the caller
+    Count
+};
+
+// Display name of a stage
+inline const char* pipelineStageName(PipelineStage stage) {
+    static const char* names[] = { "Pipeline geometry", "Pipeline binning", "Pipeline raster", "Pipeline present" };
+    return stage < PipelineStage::Count ? names[static_cast<int>(stage)] : "Pipeline";
+}
+
+// Renders a stream of frames with the stages above running concurrently on different frames: while frame N is
+// rasterized, frame N + 1 can be in the geometry stage and frame N - 1 presented. Each stage hands frames to the
+// next through a bounded queue, and a fixed pool of frames (each with its own render target) limits how far
+// submission can run ahead, so throughput approaches the slowest stage instead of the sum of all of them.
+// Every pixel is shaded exactly as renderScene would shade it after sorting the draws like RenderCommandBuffer.
+template <typename Shader>
+class FramePipeline {
+public:
+    // Receives every finished frame, in submission order, on the present stage's thread.
+    // The target is reused for a later frame once the callback returns.
+    using PresentCallback = std::function<void(const RenderTarget& target, uint64_t frameId)>;
+
+    // Constructor: allocates framesInFlight targets of the given size and starts one thread per stage
+    FramePipeline(int width, int height, int framesInFlight, PresentCallback present);
+
+    // Destructor: finishes and presents the frames already submitted, then stops the threads
+    ~FramePipeline();
+
+    FramePipeline(const FramePipeline&) = delete;
+    FramePipeline& operator=(const FramePipeline&) = delete;
+
+    // Queue a frame and return its id; waits while every frame is in flight. The scene, its meshes and materials
+    // must not change until the frame has been presented (see flush).
+    uint64_t submit(const Scene& scene, const View& view, const Shader& shader, Color clearColor);
+
+    // Wait until every submitted frame has been presented
+    void flush();
+
+    // Resize every target; flushes first
+    void resize(int width, int height);
+
+    // Change the depth format of every target; flushes first
+    void configureDepth(DepthFormat format, bool reversedZ);
+
+    // Job system the geometry, binning and raster stages split their work over (JobSystem::instance() unless set);
+    // flushes first
+    void setJobSystem(JobSystem& jobs);
+
+    JobSystem& getJobSystem() const;
+
+    // Time the stage spent on its most recent frame, in milliseconds
+    double getStageMs(PipelineStage stage) const;
+
+    int getFramesInFlight() const;
+
+private:
+    static_assert(isCopyableShader<Shader>, "Shader is copied by value, so it must be a final shader type such as PhongShader, not the shaderProgram interface");
+
+    // Everything one frame in flight owns; storage is kept between the frames that reuse it
+    struct Frame {
+        explicit Frame(int width, int height) : target(width, height) {
+        }
+
+        RenderTarget target;                     // Where the frame is rasterized
+        const Scene* scene = nullptr;            // What to draw
+        View view;                               // Camera and light
+        Shader prototype;                        // Shader settings from submit()
+        Color clearColor = { 0, 0, 0, 255 };     // Background
+        uint64_t id = 0;                         // Submission number
+        RenderCommandBuffer commands;            // Draws sorted by state and depth
+        TiledRenderer<Shader> tiles;             // Triangles of the draws, binned into tiles
+    };
+
+    // Loop of one stage thread: take frames from input, process them, pass them on
+    void runStage(PipelineStage stage);
+
+    void processGeometry(Frame& frame);
+
+    void processBinning(Frame& frame);
+
+    void processRaster(Frame& frame);
+
+    void processPresent(Frame& frame);
+
+    static const int StageCount = static_cast<int>(PipelineStage::Count);
+
+    int width;                                                // Width of every target
+    int height;                                               // Height of every target
+    PresentCallback present;                                  // Consumer of finished frames
+    std::vector<std::unique_ptr<Frame>> frames;               // Frame pool
+    BoundedQueue<Frame*> freeFrames;                          // Frames ready for submit()
+    std::unique_ptr<BoundedQueue<Frame*>> queues[StageCount]; // Input queue of each stage
+    std::atomic<double> stageMs[StageCount];                  // Latest time of each stage
+    std::vector<std::thread> threads;                         // One thread per stage
+    uint64_t submitted;                                       // Frames passed to submit()
+    uint64_t presented;                                       // Frames returned to the pool
+    std::mutex flushMutex;                                    // Guards submitted and presented
+    std::condition_variable frameDone;                        // Signalled after every present
+};
+
+template <typename Shader>
+FramePipeline<Shader>::FramePipeline(int width, int height, int framesInFlight, PresentCallback present)
+    : width(width), height(height), present(std::move(present)), freeFrames(framesInFlight), submitted(0), presented(0) {
+    for (int i = 0; i < framesInFlight; ++i) {
+        frames.push_back(std::make_unique<Frame>(width, height));
+        freeFrames.push(frames.back().get());
+    }
+    for (int stage = 0; stage < StageCount; ++stage) {
+        queues[stage] = std::make_unique<BoundedQueue<Frame*>>(framesInFlight);
+        stageMs[stage] = 0.0;
+    }
+    for (int stage = 0; stage < StageCount; ++stage) {
+        threads.emplace_back(&FramePipeline::runStage, this, static_cast<PipelineStage>(stage));
+    }
+}
+
+template <typename Shader>
+FramePipeline<Shader>::~FramePipeline() {
+    // Closing the first queue drains the pipeline: each stage closes the next one when its input runs dry
+    queues[0]->close();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    freeFrames.close();
+}
+
+template <typename Shader>
+uint64_t FramePipeline<Shader>::submit(const Scene& scene, const View& view, const Shader& shader, Color clearColor) {
+    Frame* frame = nullptr;
+    freeFrames.pop(frame);
+
+    {
+        std::lock_guard<std::mutex> lock(flushMutex);
+        frame->id = submitted++;
+    }
+    frame->scene = &scene;
+    frame->view = view;
+    frame->prototype = shader;
+    frame->clearColor = clearColor;
+    queues[0]->push(frame);
+    return frame->id;
+}
+
+template <typename Shader>
+void FramePipeline<Shader>::flush() {
+    std::unique_lock<std::mutex> lock(flushMutex);
+    frameDone.wait(lock, [this] { return presented == submitted; });
+}
+
+template <typename Shader>
+void FramePipeline<Shader>::resize(int newWidth, int newHeight) {
+    flush();
+    width = newWidth;
+    height = newHeight;
+    for (std::unique_ptr<Frame>& frame : frames) {
+        frame->target.resize(width, height);
+    }
+}
+
+template <typename Shader>
+void FramePipeline<Shader>::configureDepth(DepthFormat format, bool reversedZ) {
+    flush();
+    for (std::unique_ptr<Frame>& frame : frames) {
+        frame->target.getDepthBuffer().configure(format, reversedZ);
+    }
+}
+
+template <typename Shader>
+void FramePipeline<Shader>::setJobSystem(JobSystem& jobs) {
+    flush();
+    for (std::unique_ptr<Frame>& frame : frames) {
+        frame->tiles.setJobSystem(jobs);
+    }
+}
+
+template <typename Shader>
+JobSystem& FramePipeline<Shader>::getJobSystem() const {
+    return frames.front()->tiles.getJobSystem();
+}
+
+template <typename Shader>
+double FramePipeline<Shader>::getStageMs(PipelineStage stage) const {
+    return stageMs[static_cast<int>(stage)];
+}
+
+template <typename Shader>
+int FramePipeline<Shader>::getFramesInFlight() const {
+    return static_cast<int>(frames.size());
+}
+
+template <typename Shader>
+void FramePipeline<Shader>::runStage(PipelineStage stage) {
+    int index = static_cast<int>(stage);
+    TRACE_THREAD_NAME(pipelineStageName(stage));
+
+    Frame* frame = nullptr;
+    while (queues[index]->pop(frame)) {
+        auto start = std::chrono::steady_clock::now();
+        switch (stage) {
+        case PipelineStage::Geometry:
+            processGeometry(*frame);
+            break;
+        case PipelineStage::Binning:
+            processBinning(*frame);
+            break;
+        case PipelineStage::Raster:
+            processRaster(*frame);
+            break;
+        default:
+            processPresent(*frame);
+            break;
+        }
+        stageMs[index] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (stage == PipelineStage::Present) {
+            freeFrames.push(frame);
+            {
+                std::lock_guard<std::mutex> lock(flushMutex);
+                presented++;
+            }
+            frameDone.notify_all();
+        }
+        else {
+            queues[index + 1]->push(frame);
+        }
+    }
+
+    if (index + 1 < StageCount) {
+        queues[index + 1]->close();
+    }
+}
+
+// Function to sort the draws, transform each instance's vertices and keep the triangles that reach the target
+template <typename Shader>
+void FramePipeline<Shader>::processGeometry(Frame& frame) {
+    frame.commands.clear();
+    frame.commands.recordScene(*frame.scene, frame.prototype);
+    frame.commands.sort(frame.view.viewMatrix);
+    frame.tiles.setup(frame.commands, frame.view, frame.prototype, frame.target);
+}
+
+// Function to list, for every tile, the triangles whose bounding box overlaps it
+template <typename Shader>
+void FramePipeline<Shader>::processBinning(Frame& frame) {
+    frame.tiles.bin();
+}
+
+// Function to rasterize every tile's triangles in their original order; the tiles without any are cleared by the same
+// jobs, so the frame needs no separate resolve
+template <typename Shader>
+void FramePipeline<Shader>::processRaster(Frame& frame) {
+    frame.target.clear(frame.clearColor);
+    frame.tiles.rasterize(frame.target);
+}
+
+// Function to pass the finished image to the caller
+template <typename Shader>
+void FramePipeline<Shader>::processPresent(Frame& frame) {
+    TRACE_SCOPE("Present");
+    if (present) {
+        present(frame.target, frame.id);
+    }
+}
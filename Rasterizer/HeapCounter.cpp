@@ -0,0 +1,53 @@
+#include "Profiler.h"
+#include <cstdlib>
+#include <new>
+
+// Replacements of the global allocation functions that count every allocation for Profiler::getHeapAllocationCount.
+// Replacing them affects the whole process, so this file is not part of the renderer library: only the executables
+// that read the count (the viewer and the allocation test) compile it in. Over-aligned allocations keep the standard
+// library's functions and are not counted.
+
+void* operator new(std::size_t size) {
+    Profiler::countHeapAllocation();
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    Profiler::countHeapAllocation();
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
@@ -0,0 +1,339 @@
+#include "JobSystem.h"
+#include "NumaTopology.h"
+#include "TraceRecorder.h"
+#include <iostream>
+
+namespace {
+
+// Times an idle worker looks for jobs before it sleeps
+const int SpinsBeforeSleep = 64;
+
+// Which system's worker the calling thread is, if any
+struct WorkerSlot {
+    const JobSystem* system;
+    int thread;
+};
+
+thread_local WorkerSlot workerSlot = { nullptr, 0 };
+
+}
+
+// Constructor: An empty ring
+JobSystem::WorkDeque::WorkDeque() : head(0), count(0) {
+}
+
+// Function to queue a job at the back of the ring
+bool JobSystem::WorkDeque::push(Job* job) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count == static_cast<size_t>(PoolSize)) {
+        return false;
+    }
+    jobs[(head + count) % PoolSize] = job;
+    count++;
+    return true;
+}
+
+// Function to take the job queued last
+Job* JobSystem::WorkDeque::popBack() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count == 0) {
+        return nullptr;
+    }
+    count--;
+    return jobs[(head + count) % PoolSize];
+}
+
+// Function to take the job queued first
+Job* JobSystem::WorkDeque::popFront() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count == 0) {
+        return nullptr;
+    }
+    Job* job = jobs[head];
+    head = (head + 1) % PoolSize;
+    count--;
+    return job;
+}
+
+// Constructor: Start the workers
+JobSystem::JobSystem(int threadCount, bool pinThreads, int firstCore)
+    : threadCount(threadCount), pinThreads(pinThreads), firstCore(firstCore), nodeCount(1), queued(0), sleepers(0),
+      stopping(false) {
+    start();
+}
+
+// Destructor: Join the workers; jobs still queued are dropped
+JobSystem::~JobSystem() {
+    stop();
+}
+
+// Function to get the process-wide job system
+JobSystem& JobSystem::instance() {
+    static JobSystem jobs;
+    return jobs;
+}
+
+// Function to replace the workers by a new set
+void JobSystem::configure(int newThreadCount, bool newPinThreads, int newFirstCore) {
+    stop();
+    threadCount = newThreadCount;
+    pinThreads = newPinThreads;
+    firstCore = newFirstCore;
+    start();
+}
+
+void JobSystem::start() {
+    if (threadCount <= DefaultThreads) {
+        threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    deques.clear();
+    for (int thread = 0; thread < threadCount; ++thread) {
+        deques.push_back(std::make_unique<WorkDeque>());
+    }
+    placeWorkers();
+    queued = 0;
+    stopping = false;
+    for (int thread = 1; thread < threadCount; ++thread) {
+        workers.emplace_back(&JobSystem::workerLoop, this, thread);
+    }
+}
+
+void JobSystem::stop() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+// Function to take the next finished job of the calling thread's ring. A slot is free once its count has reached zero:
+// finish() touches nothing after that, and a job stolen by another thread keeps its slot for as long as it runs.
+// The caller may run jobs here, as in wait(), so it must not hold a lock those jobs take.
+Job* JobSystem::allocate(void (*function)(Job& job), Job* parent) {
+    static thread_local std::unique_ptr<Job[]> pool;
+    static thread_local size_t next = 0;
+    if (!pool) {
+        pool.reset(new Job[PoolSize]());
+    }
+
+    Job* job = &pool[next];
+    for (int tried = 1; job->unfinished.load(std::memory_order_acquire) != 0; ++tried) {
+        // Every slot is still in use. Jobs queued but not yet run may hold them, and on a system of one thread no one
+        // else runs those, so run one here; with nothing queued the jobs are running on other threads.
+        if (tried % PoolSize == 0) {
+            Job* queuedJob = findJob(localThread());
+            if (queuedJob) {
+                execute(queuedJob);
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+        next = (next + 1) % PoolSize;
+        job = &pool[next];
+    }
+    next = (next + 1) % PoolSize;
+
+    job->function = function;
+    job->parent = parent;
+    job->unfinished.store(1, std::memory_order_relaxed);
+    if (parent) {
+        parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+Job* JobSystem::createGroup(Job* parent) {
+    return allocate(nullptr, parent);
+}
+
+// Function to give each worker its CPUs and node. Pinned workers take the node of their CPU; unpinned ones are dealt
+// round the nodes and may run on any CPU of theirs. The nodes in use are then numbered in order of their first worker.
+void JobSystem::placeWorkers() {
+    const NumaTopology& topology = NumaTopology::instance();
+    int cpuCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    std::vector<int> nodeIndex(topology.getNodeCount(), -1);
+    threadCpus.assign(threadCount, std::vector<int>());
+    threadNodes.assign(threadCount, 0);
+    nodeCount = 0;
+    for (int thread = 1; thread < threadCount; ++thread) {
+        int systemNode = 0;
+        if (pinThreads) {
+            int cpu = (firstCore + thread) % cpuCount;
+            threadCpus[thread].push_back(cpu);
+            systemNode = topology.getNodeOfCpu(cpu);
+        }
+        else if (topology.getNodeCount() > 1) {
+            systemNode = (thread - 1) % topology.getNodeCount();
+            threadCpus[thread] = topology.getCpus(systemNode);
+        }
+        if (nodeIndex[systemNode] < 0) {
+            nodeIndex[systemNode] = nodeCount++;
+        }
+        threadNodes[thread] = nodeIndex[systemNode];
+    }
+    nodeCount = std::max(nodeCount, 1);
+
+    nodeDeques.clear();
+    for (int node = 0; node < nodeCount; ++node) {
+        nodeDeques.push_back(std::make_unique<WorkDeque>());
+    }
+
+    // Non-workers steal from the workers only. A worker tries its node first, then the shared deque, then other nodes.
+    stealOrder.assign(threadCount, std::vector<WorkDeque*>());
+    for (int thread = 1; thread < threadCount; ++thread) {
+        stealOrder[0].push_back(deques[thread].get());
+    }
+    for (int thread = 1; thread < threadCount; ++thread) {
+        std::vector<WorkDeque*>& order = stealOrder[thread];
+        const int node = threadNodes[thread];
+        order.push_back(nodeDeques[node].get());
+        for (int offset = 1; offset < threadCount; ++offset) {
+            int other = (thread + offset) % threadCount;
+            if (other != 0 && threadNodes[other] == node) {
+                order.push_back(deques[other].get());
+            }
+        }
+        order.push_back(deques[0].get());
+        for (int offset = 1; offset < threadCount; ++offset) {
+            int other = (thread + offset) % threadCount;
+            if (other != 0 && threadNodes[other] != node) {
+                order.push_back(deques[other].get());
+            }
+        }
+        for (int offset = 1; offset < nodeCount; ++offset) {
+            order.push_back(nodeDeques[(node + offset) % nodeCount].get());
+        }
+    }
+}
+
+// Function to queue a job on the calling thread's deque and wake a worker for it
+void JobSystem::run(Job* job) {
+    if (!queue(*deques[localThread()], job)) {
+        // A full deque means plenty of queued work; running this one now keeps the caller going
+        execute(job);
+    }
+}
+
+// Function to queue a job on a node's deque, where only workers look
+void JobSystem::run(Job* job, int node) {
+    if (workers.empty()) {
+        run(job);
+        return;
+    }
+    if (!queue(*nodeDeques[node], job)) {
+        execute(job);
+    }
+}
+
+bool JobSystem::queue(WorkDeque& deque, Job* job) {
+    if (!deque.push(job)) {
+        return false;
+    }
+    queued.fetch_add(1);
+    if (sleepers.load() > 0) {
+        // Taking the lock orders this wake-up after a worker that just found no jobs has started waiting
+        { std::lock_guard<std::mutex> lock(sleepMutex); }
+        wake.notify_one();
+    }
+    return true;
+}
+
+// Function to help with queued jobs until one job's tree has finished
+void JobSystem::wait(const Job* job) {
+    const int thread = localThread();
+    while (job->unfinished.load(std::memory_order_acquire) > 0) {
+        Job* next = findJob(thread);
+        if (next) {
+            execute(next);
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// Function to run one parallelFor piece, queueing upper halves for other threads to steal
+void JobSystem::runRange(Job& job) {
+    RangeData range = *std::launder(reinterpret_cast<RangeData*>(job.data));
+    while (range.end - range.begin > range.grain) {
+        size_t middle = range.begin + (range.end - range.begin) / 2;
+        Job* upper = range.system->allocate(&runRange, job.parent);
+        new (upper->data) RangeData{ range.invoke, range.body, middle, range.end, range.grain, range.system };
+        range.system->run(upper);
+        range.end = middle;
+    }
+    range.invoke(range.body, range.begin, range.end);
+}
+
+void JobSystem::execute(Job* job) {
+    if (job->function) {
+        job->function(*job);
+    }
+    finish(job);
+}
+
+void JobSystem::finish(Job* job) {
+    // Read the parent first: once the count reaches zero the job's slot may be reused
+    Job* parent = job->parent;
+    if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1 && parent) {
+        finish(parent);
+    }
+}
+
+// Function to take a job, newest first from the calling thread's deque, then oldest first from the others in the
+// thread's steal order
+Job* JobSystem::findJob(int thread) {
+    if (queued.load(std::memory_order_relaxed) == 0) {
+        return nullptr;
+    }
+
+    Job* job = deques[thread]->popBack();
+    for (size_t i = 0; !job && i < stealOrder[thread].size(); ++i) {
+        job = stealOrder[thread][i]->popFront();
+    }
+    if (job) {
+        queued.fetch_sub(1);
+    }
+    return job;
+}
+
+// Function to run jobs on a worker, sleeping while there are none
+void JobSystem::workerLoop(int thread) {
+    TRACE_THREAD_NAME("Job worker");
+    workerSlot = { this, thread };
+    if (!threadCpus[thread].empty() && !NumaTopology::bindCurrentThread(threadCpus[thread])) {
+        std::cerr << "can't bind job worker " << thread << " to " << threadCpus[thread].size() << " CPU(s) from "
+                  << threadCpus[thread][0] << "\n";
+    }
+
+    int idleSpins = 0;
+    while (!stopping.load()) {
+        Job* job = findJob(thread);
+        if (job) {
+            execute(job);
+            idleSpins = 0;
+            continue;
+        }
+        if (++idleSpins < SpinsBeforeSleep) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepers.fetch_add(1);
+        wake.wait(lock, [this] { return queued.load() > 0 || stopping.load(); });
+        sleepers.fetch_sub(1);
+        idleSpins = 0;
+    }
+    workerSlot = { nullptr, 0 };
+}
+
+int JobSystem::localThread() const {
+    return workerSlot.system == this ? workerSlot.thread : 0;
+}
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Unit of work run by a JobSystem. A job counts as unfinished until it has run and every child created under it has
+// finished, so waiting on a parent waits for the whole tree below it.
+struct Job {
+    static const size_t DataSize = 48; // Bytes of captured state a job can hold
+
+    void (*function)(Job& job);   // Runs the job; null for a job that only groups its children
+    Job* parent;                  // Job told when this one finishes, or null
+    std::atomic<int> unfinished;  // 1 for the job itself plus one per unfinished child
+    alignas(std::max_align_t) unsigned char data[DataSize]; // Captured state, copied in by JobSystem::create
+};
+
+// Work-stealing job system shared by the loader, the vertex stage, tile binning and rasterization, the re-shade pass
+// and material baking.
+//
+// Every worker owns a deque: it pushes and pops jobs at the back, and when its deque is empty it steals the oldest job
+// from the front of another one. Threads that are not workers (the main thread, pipeline stages) queue on a shared
+// deque and work on jobs while they wait, so a system of one thread runs everything on the caller, in order.
+// parallelFor splits its range in halves until a piece is no longer than the grain, which keeps the big pieces at the
+// fronts of the deques where thieves find them.
+//
+// Jobs come from a ring of PoolSize per thread, and a finished job's slot is simply reused, so once every thread has
+// made its first job the system makes no heap allocations. At most PoolSize of one thread's jobs may be unfinished at
+// once: creating another runs queued jobs, as wait() does, until one of them has finished. parallelFor keeps only a few
+// per thread unfinished, however large its range.
+//
+// On a machine with several NUMA nodes (see NumaTopology) every worker belongs to one node, and each node has a deque
+// of its own that run(job, node) queues on. An idle worker looks at its own deque, then its node's deque and those of
+// the other workers on its node, and only then steals from other nodes, so work given to a node mostly stays there
+// and the memory it first touches is placed on that node. Threads that are not workers never take jobs queued for a
+// node.
+class JobSystem {
+public:
+    static const int PoolSize = 4096;      // Jobs per thread's ring, and capacity of each deque
+    static const int DefaultThreads = 0;   // Thread count meaning one per hardware thread
+
+    // Constructor: threadCount threads run jobs, counting the thread that waits, so threadCount - 1 workers start.
+    // With pinThreads, worker k (from 1) only runs on logical CPU (firstCore + k) modulo the CPU count. The waiting
+    // thread is left alone, so a render started with firstCore = n * threadCount keeps off the cores of n others.
+    // Without it, on a machine with several NUMA nodes worker k runs on any CPU of node (k - 1) modulo the node count.
+    explicit JobSystem(int threadCount = DefaultThreads, bool pinThreads = false, int firstCore = 0);
+
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Process-wide system used when no other is given; starts with one thread per hardware thread
+    static JobSystem& instance();
+
+    // Stop the workers and start new ones. No job may be queued or running.
+    void configure(int threadCount, bool pinThreads = false, int firstCore = 0);
+
+    // Threads running jobs, including the waiting thread; at least 1
+    int getThreadCount() const;
+
+    bool getPinThreads() const;
+
+    int getFirstCore() const;
+
+    // NUMA nodes the workers run on, numbered from 0 in order of their first worker; 1 on a single-node machine
+    int getNodeCount() const;
+
+    // A job that calls function() when it runs. The function object is copied into the job, so it must be trivially
+    // copyable and fit in Job::DataSize, as a lambda capturing a few references does.
+    template <typename Function>
+    Job* create(const Function& function, Job* parent = nullptr);
+
+    // A job that runs nothing, only finishing once its children have
+    Job* createGroup(Job* parent = nullptr);
+
+    // Queue a job; every created job must be run exactly once
+    void run(Job* job);
+
+    // Queue a job for the workers of a node (below getNodeCount()); the jobs it queues in turn stay on that node's
+    // workers unless the other nodes run out of work. Without workers the job is queued as by run(job).
+    void run(Job* job, int node);
+
+    // Work on queued jobs until a job and everything under it has finished
+    void wait(const Job* job);
+
+    // Call body(begin, end) on ranges no longer than grain that together cover [0, count) once, spread over every
+    // thread; returns when all have run. The order of the ranges is unspecified.
+    template <typename Function>
+    void parallelFor(size_t count, size_t grain, const Function& body);
+
+private:
+    // Jobs queued by one thread, guarded by a lock since thieves take from the other end
+    struct WorkDeque {
+        WorkDeque();
+
+        // Add a job at the back; false when the deque is full
+        bool push(Job* job);
+
+        // Take the newest job, or null
+        Job* popBack();
+
+        // Take the oldest job, or null
+        Job* popFront();
+
+        std::mutex mutex;
+        Job* jobs[PoolSize]; // Ring of queued jobs
+        size_t head;         // Slot of the oldest job
+        size_t count;        // Queued jobs
+    };
+
+    // State of a parallelFor piece, stored in its job
+    struct RangeData {
+        void (*invoke)(const void* body, size_t begin, size_t end);
+        const void* body;
+        size_t begin;
+        size_t end;
+        size_t grain;
+        JobSystem* system;
+    };
+
+    // Take a job from the calling thread's pool, running queued jobs while every one of its slots is in use
+    Job* allocate(void (*function)(Job& job), Job* parent);
+
+    // Call the function object stored in a job
+    template <typename Function>
+    static void callFunction(Job& job);
+
+    // Call a parallelFor body on a range
+    template <typename Function>
+    static void invokeBody(const void* body, size_t begin, size_t end);
+
+    // Split a parallelFor range until it fits the grain, queueing the upper halves
+    static void runRange(Job& job);
+
+    // Run a job and mark it finished
+    void execute(Job* job);
+
+    // Count a job, then its ancestors, as finished when nothing under them is left
+    static void finish(Job* job);
+
+    // Pop from the calling thread's deque, or steal from another; null when every deque is empty
+    Job* findJob(int thread);
+
+    // Push a queued job and wake a worker for it; false when the deque is full
+    bool queue(WorkDeque& deque, Job* job);
+
+    // Decide the CPUs and node of every worker, and the order each thread steals in
+    void placeWorkers();
+
+    // Loop of worker thread index until the system stops
+    void workerLoop(int thread);
+
+    // Start threadCount - 1 workers
+    void start();
+
+    // Stop and join the workers
+    void stop();
+
+    // Deque of the calling thread: its own for a worker of this system, the shared one (0) otherwise
+    int localThread() const;
+
+    int threadCount;                                // Threads running jobs, the waiting one included
+    bool pinThreads;                                // Pin workers to logical CPUs
+    int firstCore;                                  // CPU left to the waiting thread; worker k runs on firstCore + k
+    std::vector<std::unique_ptr<WorkDeque>> deques; // 0 is shared by non-workers, then one per worker
+    std::vector<std::unique_ptr<WorkDeque>> nodeDeques; // Jobs queued for a node, one per node in use
+    std::vector<std::vector<int>> threadCpus;       // CPUs each worker is bound to; empty when unbound
+    std::vector<int> threadNodes;                   // Node of each worker
+    std::vector<std::vector<WorkDeque*>> stealOrder; // Deques each thread steals from once its own is empty, in order
+    int nodeCount;                                  // Nodes the workers run on
+    std::vector<std::thread> workers;
+    std::atomic<int> queued;                        // Jobs in all deques
+    std::atomic<int> sleepers;                      // Workers waiting for jobs
+    std::atomic<bool> stopping;                     // Set to make the workers return
+    std::mutex sleepMutex;                          // Guards falling asleep against a wake-up
+    std::condition_variable wake;                   // Signalled when jobs are queued for sleeping workers
+};
+
+template <typename Function>
+inline Job* JobSystem::create(const Function& function, Job* parent) {
+    static_assert(sizeof(Function) <= Job::DataSize, "Job function objects must fit in Job::DataSize");
+    static_assert(alignof(Function) <= alignof(std::max_align_t), "Job function objects must not be over-aligned");
+    static_assert(std::is_trivially_copyable<Function>::value, "Job function objects are copied without constructors");
+    Job* job = allocate(&callFunction<Function>, parent);
+    new (job->data) Function(function);
+    return job;
+}
+
+template <typename Function>
+inline void JobSystem::callFunction(Job& job) {
+    (*std::launder(reinterpret_cast<Function*>(job.data)))();
+}
+
+template <typename Function>
+inline void JobSystem::invokeBody(const void* body, size_t begin, size_t end) {
+    (*static_cast<const Function*>(body))(begin, end);
+}
+
+template <typename Function>
+inline void JobSystem::parallelFor(size_t count, size_t grain, const Function& body) {
+    grain = std::max<size_t>(grain, 1);
+    if (threadCount == 1 || count <= grain) {
+        for (size_t begin = 0; begin < count; begin += grain) {
+            body(begin, std::min(begin + grain, count));
+        }
+        return;
+    }
+
+    // The pieces are children of a group, so waiting on it waits for every piece however deep the splitting went
+    Job* group = createGroup();
+    Job* root = allocate(&runRange, group);
+    new (root->data) RangeData{ &invokeBody<Function>, &body, 0, count, grain, this };
+    execute(root);
+    finish(group);
+    wait(group);
+}
+
+inline int JobSystem::getThreadCount() const {
+    return threadCount;
+}
+
+inline bool JobSystem::getPinThreads() const {
+    return pinThreads;
+}
+
+inline int JobSystem::getFirstCore() const {
+    return firstCore;
+}
+
+inline int JobSystem::getNodeCount() const {
+    return nodeCount;
+}
@@ -0,0 +1,58 @@
+#include "Material.h"
+#include "JobSystem.h"
+#include "TraceRecorder.h"
+#include <iostream>
+
+// Constructor: Initializes an empty material
+Material::Material() : width(0), height(0) {
+}
+
+// Function to pack albedo, normal and specular maps into interleaved texels
+bool Material::bake(const Texture2D& albedo, const Texture2D& normal, const Texture2D& specular) {
+    if (albedo.getWidth() == 0 || normal.getWidth() == 0 || specular.getWidth() == 0) {
+        std::cerr << "can't bake a material from an empty texture\n";
+        return false;
+    }
+
+    width = albedo.getWidth();
+    height = albedo.getHeight();
+    texels.resize(static_cast<size_t>(width) * height);
+
+    // Sample the other maps at texel centers so they may have a different resolution than the albedo. Rows are
+    // independent, so bands of them bake as separate jobs.
+    JobSystem::instance().parallelFor(height, BakeJobRows, [&](size_t rowBegin, size_t rowEnd) {
+        for (int y = static_cast<int>(rowBegin); y < static_cast<int>(rowEnd); ++y) {
+            float v = (y + 0.5f) / height;
+            for (int x = 0; x < width; ++x) {
+                float u = (x + 0.5f) / width;
+                MaterialTexel& texel = texels[y * width + x];
+
+                texel.albedoSpecular = albedo.fetch(x, y);
+                texel.albedoSpecular.a = specular.sample<TextureWrap::Clamp>(u, v).b;
+                texel.normal = normal.sample<TextureWrap::Clamp>(u, v);
+            }
+        }
+    });
+
+    return true;
+}
+
+// Function to read the three maps from TGA files and bake them
+bool Material::loadFromFiles(const char* albedoFile, const char* normalFile, const char* specularFile) {
+    TRACE_SCOPE("Load material");
+    Texture2D albedo;
+    Texture2D normal;
+    Texture2D specular;
+
+    // The maps are read and converted as three children of one job; baking waits for all of them
+    JobSystem& jobs = JobSystem::instance();
+    bool loaded[3] = { false, false, false };
+    Job* load = jobs.createGroup();
+    jobs.run(jobs.create([&albedo, albedoFile, &loaded] { loaded[0] = albedo.loadFromFile(albedoFile); }, load));
+    jobs.run(jobs.create([&normal, normalFile, &loaded] { loaded[1] = normal.loadFromFile(normalFile); }, load));
+    jobs.run(jobs.create([&specular, specularFile, &loaded] { loaded[2] = specular.loadFromFile(specularFile); }, load));
+    jobs.run(load);
+    jobs.wait(load);
+
+    return loaded[0] && loaded[1] && loaded[2] && bake(albedo, normal, specular);
+}
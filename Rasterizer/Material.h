@@ -0,0 +1,107 @@
+#pragma once
+
+#include "ShadingMath.h"
+#include "Texture2D.h"
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Everything the fragment shader reads for one texel, interleaved into 64 bits so a fragment needs a single fetch
+struct MaterialTexel {
+    Texel albedoSpecular; // RGB = albedo color, A = specular exponent
+    Texel normal;         // RGB = normal encoded as in the source normal map, A unused
+};
+
+// Surface material baked at load time from separate albedo, normal and specular maps
+class Material {
+public:
+    // Rows per baking job
+    static const int BakeJobRows = 32;
+
+    // Constructor for an empty material
+    Material();
+
+    // Pack the three maps into one texture at the albedo map's resolution
+    bool bake(const Texture2D& albedo, const Texture2D& normal, const Texture2D& specular);
+
+    // Read the three TGA files and bake them
+    bool loadFromFiles(const char* albedoFile, const char* normalFile, const char* specularFile);
+
+    // Sample the nearest packed texel at normalized texture coordinates
+    template <TextureWrap Wrap = TextureWrap::Repeat>
+    MaterialTexel sample(float u, float v) const;
+
+#ifdef RASTERIZER_SSE
+    // Sample four lanes at once (repeat addressing); each output lane holds the texel packed as R | G << 8 | B << 16 | A << 24
+    void sample4(__m128 u, __m128 v, __m128i& albedoSpecular, __m128i& normal) const;
+#endif
+
+    int getWidth() const;
+
+    int getHeight() const;
+
+private:
+    std::vector<MaterialTexel> texels; // Packed texels, row-major
+    int width;                         // Material width in texels
+    int height;                        // Material height in texels
+};
+
+template <TextureWrap Wrap>
+inline MaterialTexel Material::sample(float u, float v) const {
+    return texels[texelIndex<Wrap>(u, v, width, height)];
+}
+
+#ifdef RASTERIZER_SSE
+inline void Material::sample4(__m128 u, __m128 v, __m128i& albedoSpecular, __m128i& normal) const {
+    // Repeat addressing: keep the fractional part (floor without SSE4.1)
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 uWhole = _mm_cvtepi32_ps(_mm_cvttps_epi32(u));
+    __m128 vWhole = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+    uWhole = _mm_sub_ps(uWhole, _mm_and_ps(_mm_cmpgt_ps(uWhole, u), one));
+    vWhole = _mm_sub_ps(vWhole, _mm_and_ps(_mm_cmpgt_ps(vWhole, v), one));
+
+    // Scale to texel space and clamp in float (SSE2 has no 32-bit integer min/max); the coordinates stay exact
+    __m128 x = _mm_mul_ps(_mm_sub_ps(u, uWhole), _mm_set1_ps(static_cast<float>(width)));
+    __m128 y = _mm_mul_ps(_mm_sub_ps(v, vWhole), _mm_set1_ps(static_cast<float>(height)));
+    x = _mm_min_ps(_mm_max_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(x)), _mm_setzero_ps()), _mm_set1_ps(static_cast<float>(width - 1)));
+    y = _mm_min_ps(_mm_max_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(y)), _mm_setzero_ps()), _mm_set1_ps(static_cast<float>(height - 1)));
+
+    // The index itself is integer math: in float, y * width + x loses bits from 2^24 texels on and can land past the end.
+    // SSE2 only multiplies the even lanes, so the odd rows are shifted into place for a second multiply.
+    __m128i row = _mm_cvttps_epi32(y);
+    __m128i widthI = _mm_set1_epi32(width);
+    __m128i evenStart = _mm_shuffle_epi32(_mm_mul_epu32(row, widthI), _MM_SHUFFLE(0, 0, 2, 0));
+    __m128i oddStart = _mm_shuffle_epi32(_mm_mul_epu32(_mm_srli_epi64(row, 32), widthI), _MM_SHUFFLE(0, 0, 2, 0));
+    __m128i index = _mm_add_epi32(_mm_unpacklo_epi32(evenStart, oddStart), _mm_cvttps_epi32(x));
+
+#ifdef __AVX2__
+    // Hardware gather of four 64-bit texels
+    __m256i texels = _mm256_i32gather_epi64(reinterpret_cast<const long long*>(this->texels.data()), index, 8);
+    __m128i low = _mm256_castsi256_si128(texels);
+    __m128i high = _mm256_extracti128_si256(texels, 1);
+#else
+    alignas(16) int lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), index);
+    __m128i low = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&texels[lanes[0]])),
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&texels[lanes[1]])));
+    __m128i high = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&texels[lanes[2]])),
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&texels[lanes[3]])));
+#endif
+
+    // De-interleave: even 32-bit words are albedo/specular, odd words are normals
+    __m128 lowF = _mm_castsi128_ps(low);
+    __m128 highF = _mm_castsi128_ps(high);
+    albedoSpecular = _mm_castps_si128(_mm_shuffle_ps(lowF, highF, _MM_SHUFFLE(2, 0, 2, 0)));
+    normal = _mm_castps_si128(_mm_shuffle_ps(lowF, highF, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+#endif
+
+inline int Material::getWidth() const {
+    return width;
+}
+
+inline int Material::getHeight() const {
+    return height;
+}
@@ -1,7 +1,8 @@
-#pragma once
 #include "Matrix.h"
+#include <cmath>
+#include <cstring>
 
-float depth = 255.0f; // Global variable to store the depth of the scene
+float depth = 1.0f; // Depth range of the viewport transform: screen z lands in [0, depth]
 
 // Constructor for a 4x4 matrix initialized to zero
 Matrix::Matrix()
@@ -38,8 +39,12 @@ float* Matrix::operator[](int index) {
     return m[index];
 }
 
+const float* Matrix::operator[](int index) const {
+    return m[index];
+}
+
 // Helper function to calculate the determinant of a 3x3 matrix
-float Matrix::determinant3x3(const std::vector<std::vector<float>>& mat) const {
+float Matrix::determinant3x3(const float mat[3][3]) const {
     return mat[0][0] * (mat[1][1] * mat[2][2] - mat[1][2] * mat[2][1]) -
         mat[0][1] * (mat[1][0] * mat[2][2] - mat[1][2] * mat[2][0]) +
         mat[0][2] * (mat[1][0] * mat[2][1] - mat[1][1] * mat[2][0]);
@@ -52,7 +57,7 @@ float Matrix::determinant() const {
     // We will use cofactor expansion along the first row (index 0)
     for (int col = 0; col < 4; ++col) {
         // Create a 3x3 submatrix by excluding the first row and the current column
-        std::vector<std::vector<float>> submatrix(3, std::vector<float>(3));
+        float submatrix[3][3];
         for (int i = 1; i < 4; ++i) {
             int sub_col = 0;
             for (int j = 0; j < 4; ++j) {
@@ -84,7 +89,7 @@ Matrix Matrix::inverse() const {
     for (int row = 0; row < 4; ++row) {
         for (int col = 0; col < 4; ++col) {
             // Create a 3x3 submatrix by excluding the current row and column
-            std::vector<std::vector<float>> submatrix(3, std::vector<float>(3));
+            float submatrix[3][3];
             int sub_row = 0;
             for (int i = 0; i < 4; ++i) {
                 if (i == row) continue; // Skip the current row
@@ -169,6 +174,36 @@ Matrix projectionMatrix(float coeff) {
     return m; // Return the resulting viewport matrix
 }
 
+Matrix translationMatrix(const Vertex& offset) {
+    Matrix m = Matrix::identity(4);
+
+    m[0][3] = offset.x;
+    m[1][3] = offset.y;
+    m[2][3] = offset.z;
+    return m;
+}
+
+Matrix scaleMatrix(float scale) {
+    Matrix m = Matrix::identity(4);
+
+    m[0][0] = scale;
+    m[1][1] = scale;
+    m[2][2] = scale;
+    return m;
+}
+
+Matrix rotationYMatrix(float angle) {
+    Matrix m = Matrix::identity(4);
+    float c = std::cos(angle);
+    float s = std::sin(angle);
+
+    m[0][0] = c;
+    m[0][2] = s;
+    m[2][0] = -s;
+    m[2][2] = c;
+    return m;
+}
+
 Matrix lookAt(Vertex& camera, Vertex& target, Vertex& up) {
     // Calculate the forward vector
     Vertex forward = { camera.x - target.x, camera.y - target.y, camera.z - target.z };
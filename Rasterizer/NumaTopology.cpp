@@ -0,0 +1,143 @@
+#include "NumaTopology.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// Function to parse a Linux CPU or node list such as "0-3,8-11"
+std::vector<int> parseList(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.find_first_of("0123456789") == std::string::npos) {
+            continue;
+        }
+        size_t dash = range.find('-');
+        int first = std::atoi(range.c_str());
+        int last = dash == std::string::npos ? first : std::atoi(range.c_str() + dash + 1);
+        for (int value = first; value <= last; ++value) {
+            values.push_back(value);
+        }
+    }
+    return values;
+}
+
+// Function to read the first line of a file; empty if it can't be read
+std::string readLine(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+}
+
+// Function to get the topology, reading it on first use
+const NumaTopology& NumaTopology::instance() {
+    static NumaTopology topology;
+    return topology;
+}
+
+// Constructor: Read the nodes, or split the CPUs into the nodes RASTERIZER_NUMA_NODES asks for
+NumaTopology::NumaTopology() {
+    int cpuCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    const char* forcedNodes = std::getenv("RASTERIZER_NUMA_NODES");
+    int nodeCount = forcedNodes ? std::max(1, std::atoi(forcedNodes)) : 0;
+    if (nodeCount == 0 && readSystemNodes()) {
+        return;
+    }
+
+    // Contiguous runs of CPUs; with more nodes than CPUs the nodes share them
+    nodeCount = std::max(1, nodeCount);
+    nodeCpus.assign(nodeCount, std::vector<int>());
+    for (int node = 0; node < nodeCount; ++node) {
+        int first = node * cpuCount / nodeCount;
+        int last = (node + 1) * cpuCount / nodeCount;
+        for (int cpu = first; cpu < last; ++cpu) {
+            nodeCpus[node].push_back(cpu);
+        }
+        if (nodeCpus[node].empty()) {
+            nodeCpus[node].push_back(node % cpuCount);
+        }
+    }
+}
+
+// Function to read the nodes that have CPUs; memory-only nodes are left out
+bool NumaTopology::readSystemNodes() {
+    nodeCpus.clear();
+#if defined(_WIN32)
+    ULONG highestNode = 0;
+    if (!GetNumaHighestNodeNumber(&highestNode)) {
+        return false;
+    }
+    for (ULONG node = 0; node <= highestNode; ++node) {
+        GROUP_AFFINITY affinity = {};
+        if (!GetNumaNodeProcessorMaskEx(static_cast<USHORT>(node), &affinity)) {
+            continue;
+        }
+        std::vector<int> cpus;
+        for (int bit = 0; bit < 64; ++bit) {
+            if (affinity.Mask & (static_cast<KAFFINITY>(1) << bit)) {
+                cpus.push_back(affinity.Group * 64 + bit);
+            }
+        }
+        if (!cpus.empty()) {
+            nodeCpus.push_back(cpus);
+        }
+    }
+#elif defined(__linux__)
+    for (int node : parseList(readLine("/sys/devices/system/node/online"))) {
+        std::vector<int> cpus = parseList(readLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+        if (!cpus.empty()) {
+            nodeCpus.push_back(cpus);
+        }
+    }
+#endif
+    return !nodeCpus.empty();
+}
+
+// Function to find the node of a logical CPU
+int NumaTopology::getNodeOfCpu(int cpu) const {
+    for (size_t node = 0; node < nodeCpus.size(); ++node) {
+        if (std::find(nodeCpus[node].begin(), nodeCpus[node].end(), cpu) != nodeCpus[node].end()) {
+            return static_cast<int>(node);
+        }
+    }
+    return 0;
+}
+
+// Function to restrict the calling thread to a set of logical CPUs
+bool NumaTopology::bindCurrentThread(const std::vector<int>& cpus) {
+#if defined(_WIN32)
+    // Affinity masks cover one processor group of 64 CPUs
+    DWORD_PTR mask = 0;
+    for (int cpu : cpus) {
+        mask |= static_cast<DWORD_PTR>(1) << (cpu % 64);
+    }
+    return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        CPU_SET(cpu, &set);
+    }
+    return !cpus.empty() && pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
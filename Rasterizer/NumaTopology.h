@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+// NUMA nodes of the machine and the logical CPUs in each, read once from the operating system: /sys/devices/system/node
+// on Linux, the NUMA node processor masks on Windows. Where neither is available the machine is one node holding every
+// CPU. Setting the environment variable RASTERIZER_NUMA_NODES to n splits the CPUs into n nodes instead, which runs the
+// NUMA-aware paths on a single-socket machine.
+class NumaTopology {
+public:
+    // Topology of this machine
+    static const NumaTopology& instance();
+
+    // Number of nodes; at least 1
+    int getNodeCount() const;
+
+    // Logical CPUs of a node; never empty
+    const std::vector<int>& getCpus(int node) const;
+
+    // Node holding a logical CPU; 0 for a CPU the topology doesn't list
+    int getNodeOfCpu(int cpu) const;
+
+    // Restrict the calling thread to a set of logical CPUs; returns false if the system refused
+    static bool bindCurrentThread(const std::vector<int>& cpus);
+
+private:
+    // Constructor: reads the topology, or splits the CPUs as RASTERIZER_NUMA_NODES asks
+    NumaTopology();
+
+    // Read the nodes from the operating system; false when it reports none
+    bool readSystemNodes();
+
+    std::vector<std::vector<int>> nodeCpus; // Logical CPUs of each node
+};
+
+inline int NumaTopology::getNodeCount() const {
+    return static_cast<int>(nodeCpus.size());
+}
+
+inline const std::vector<int>& NumaTopology::getCpus(int node) const {
+    return nodeCpus[node];
+}
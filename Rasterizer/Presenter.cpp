@@ -0,0 +1,187 @@
+#include "Presenter.h"
+#include "Profiler.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <stdio.h>
+
+// Constructor: Starts an empty measurement window
+FrameRateCounter::FrameRateCounter() : windowStart(std::chrono::steady_clock::now()), frames(0), fps(0.0) {
+}
+
+// Function to count a frame and close the measurement window every half second
+void FrameRateCounter::tick() {
+    ++frames;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - windowStart).count();
+    if (seconds >= 0.5) {
+        fps.store(frames / seconds);
+        frames = 0;
+        windowStart = now;
+    }
+}
+
+// Function to get the rate of the last complete window
+double FrameRateCounter::getFps() const {
+    return fps.load();
+}
+
+// Constructor: Nothing runs until start()
+Presenter::Presenter(SDL_Window* window)
+    : window(window), renderer(nullptr), texture(nullptr), textureWidth(0), textureHeight(0), writeIndex(0), readyIndex(1),
+      displayIndex(2), fresh(false), started(false), stopping(false), vsyncEnabled(true), outputWidth(0), outputHeight(0) {
+}
+
+// Destructor: Stops the presentation thread, which releases the renderer it created
+Presenter::~Presenter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+// Function to start the presentation thread and wait until it created its renderer
+bool Presenter::start(bool vsync) {
+    vsyncEnabled = vsync;
+    thread = std::thread(&Presenter::run, this, vsync);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    wake.wait(lock, [this] { return started; });
+    return renderer != nullptr;
+}
+
+// Function to copy a frame into the free buffer and swap it with the waiting one
+void Presenter::publish(const RenderTarget& target) {
+    PROFILE_SCOPE(ProfileStage::Present);
+    TRACE_SCOPE("Publish");
+    Image& image = images[writeIndex];
+    image.width = target.getWidth();
+    image.height = target.getHeight();
+    image.pixels.resize(static_cast<size_t>(image.width) * image.height);
+    for (int y = 0; y < image.height; ++y) {
+        const uint32_t* row = target.getColorData() + static_cast<size_t>(y) * target.getStride();
+        std::copy(row, row + image.width, image.pixels.begin() + static_cast<size_t>(y) * image.width);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::swap(writeIndex, readyIndex);
+        fresh = true;
+    }
+    wake.notify_all();
+    renderRate.tick();
+}
+
+// Function to request a vsync state; the presentation thread applies it before its next present
+void Presenter::setVSync(bool vsync) {
+    vsyncEnabled = vsync;
+}
+
+// Function to get the drawable size of the window
+void Presenter::getOutputSize(int& width, int& height) const {
+    width = outputWidth;
+    height = outputHeight;
+}
+
+double Presenter::getRenderFps() const {
+    return renderRate.getFps();
+}
+
+double Presenter::getDisplayFps() const {
+    return displayRate.getFps();
+}
+
+// Function run by the presentation thread: owns the renderer and shows the newest image whenever one arrives
+void Presenter::run(bool vsync) {
+    TRACE_THREAD_NAME("Presenter");
+
+    // SDL renderers must be used on the thread that created them, so this thread creates its own
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | (vsync ? SDL_RENDERER_PRESENTVSYNC : 0));
+    if (renderer == nullptr) {
+        printf("Error: SDL_CreateRenderer() failed: %s\n", SDL_GetError());
+    }
+    else {
+        int width = 0;
+        int height = 0;
+        SDL_GetRendererOutputSize(renderer, &width, &height);
+        outputWidth = width;
+        outputHeight = height;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        started = true;
+    }
+    wake.notify_all();
+    if (renderer == nullptr) {
+        return;
+    }
+
+    bool appliedVSync = vsync;
+    while (true) {
+        bool newFrame = false;
+        {
+            // Wake up now and then without a new frame to notice window resizes
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait_for(lock, std::chrono::milliseconds(100), [this] { return stopping || fresh; });
+            if (stopping) {
+                break;
+            }
+            if (fresh) {
+                std::swap(displayIndex, readyIndex);
+                fresh = false;
+                newFrame = true;
+            }
+        }
+
+        if (appliedVSync != vsyncEnabled) {
+            appliedVSync = vsyncEnabled;
+            SDL_RenderSetVSync(renderer, appliedVSync ? 1 : 0);
+        }
+
+        int width = 0;
+        int height = 0;
+        SDL_GetRendererOutputSize(renderer, &width, &height);
+        bool resized = width != outputWidth || height != outputHeight;
+        outputWidth = width;
+        outputHeight = height;
+
+        // A resized window is repainted with the last image until the producer catches up with the new size
+        if ((newFrame || resized) && images[displayIndex].width > 0) {
+            present(images[displayIndex]);
+        }
+    }
+
+    if (texture != nullptr) {
+        SDL_DestroyTexture(texture);
+    }
+    SDL_DestroyRenderer(renderer);
+    renderer = nullptr;
+}
+
+// Function to upload one image and present it; may wait for the display refresh
+void Presenter::present(const Image& image) {
+    PROFILE_SCOPE(ProfileStage::Present);
+    TRACE_SCOPE("Present");
+    if (texture == nullptr || textureWidth != image.width || textureHeight != image.height) {
+        if (texture != nullptr) {
+            SDL_DestroyTexture(texture);
+        }
+        texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, image.width, image.height);
+        if (texture == nullptr) {
+            printf("Error: SDL_CreateTexture() failed: %s\n", SDL_GetError());
+            textureWidth = 0;
+            textureHeight = 0;
+            return;
+        }
+        textureWidth = image.width;
+        textureHeight = image.height;
+    }
+
+    SDL_UpdateTexture(texture, nullptr, image.pixels.data(), image.width * static_cast<int>(sizeof(uint32_t)));
+    SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+    SDL_RenderPresent(renderer);
+    displayRate.tick();
+}
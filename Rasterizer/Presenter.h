@@ -0,0 +1,94 @@
+#pragma once
+
+#include "RenderTarget.h"
+#include <SDL.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Frames per second measured over half-second windows. tick() is called from one thread, getFps() from any.
+class FrameRateCounter {
+public:
+    FrameRateCounter();
+
+    // Count one frame
+    void tick();
+
+    double getFps() const;
+
+private:
+    std::chrono::steady_clock::time_point windowStart; // Start of the current measurement window
+    int frames;                                        // Frames counted in the current window
+    std::atomic<double> fps;                           // Rate of the last complete window
+};
+
+// Shows rendered images in a window from a dedicated thread, so a vsync wait in SDL_RenderPresent stalls only
+// that thread and never the renderer. Images go through three buffers: the producer fills one while the
+// presenter shows another and the third holds the newest finished image. A producer that runs ahead of the
+// display replaces the waiting image instead of blocking, so frames are dropped rather than queued.
+class Presenter {
+public:
+    // Constructor: presents into the given window once start() succeeds
+    explicit Presenter(SDL_Window* window);
+
+    // Stops the presentation thread and destroys its renderer
+    ~Presenter();
+
+    // Create the window's SDL renderer on the presentation thread; returns false if that fails
+    bool start(bool vsync);
+
+    // Copy the color attachment of a resolved target into the free buffer and hand it to the presentation thread.
+    // Never waits for the display. Only one thread may publish at a time.
+    void publish(const RenderTarget& target);
+
+    // Wait for the display refresh in SDL_RenderPresent (capped) or present as fast as frames arrive (uncapped)
+    void setVSync(bool vsync);
+
+    // Drawable size of the window in pixels, as last seen by the presentation thread
+    void getOutputSize(int& width, int& height) const;
+
+    // Rate at which publish() receives frames
+    double getRenderFps() const;
+
+    // Rate at which frames reach the window
+    double getDisplayFps() const;
+
+private:
+    // A CPU-side copy of one rendered image
+    struct Image {
+        std::vector<uint32_t> pixels; // Tightly packed SDL_PIXELFORMAT_ARGB8888 rows
+        int width = 0;
+        int height = 0;
+    };
+
+    // Body of the presentation thread
+    void run(bool vsync);
+
+    // Upload an image to the streaming texture, recreating it when the size changed, and present it
+    void present(const Image& image);
+
+    SDL_Window* window;                 // Window presented into
+    SDL_Renderer* renderer;             // Created, used and destroyed on the presentation thread only
+    SDL_Texture* texture;               // Streaming texture the images are uploaded to
+    int textureWidth;                   // Size of texture
+    int textureHeight;
+    Image images[3];                    // Triple buffer
+    int writeIndex;                     // Image the producer fills next; owned by the producer
+    int readyIndex;                     // Newest finished image; guarded by mutex
+    int displayIndex;                   // Image on screen; owned by the presentation thread
+    bool fresh;                         // True when readyIndex holds an image not shown yet
+    bool started;                       // Set once the renderer was created (or failed to be)
+    bool stopping;                      // Set by the destructor
+    std::mutex mutex;                   // Guards readyIndex, fresh, started and stopping
+    std::condition_variable wake;       // Signalled on publish, start and stop
+    std::atomic<bool> vsyncEnabled;     // Requested vsync state
+    std::atomic<int> outputWidth;       // Drawable size in pixels
+    std::atomic<int> outputHeight;
+    FrameRateCounter renderRate;        // Ticked by publish()
+    FrameRateCounter displayRate;       // Ticked after every present
+    std::thread thread;                 // Presentation thread
+};
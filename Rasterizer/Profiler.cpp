@@ -0,0 +1,191 @@
+#include "Profiler.h"
+#include <algorithm>
+
+namespace {
+
+// Calls to the counting operator new; a plain atomic so counting never allocates or takes a lock
+std::atomic<uint64_t> heapAllocations(0);
+
+// Totals of the calling thread, registered with the profiler on first use and folded into it when the thread exits
+struct ThreadSlot {
+    Profiler::ThreadTotals totals;
+
+    ThreadSlot() {
+        for (std::atomic<uint64_t>& value : totals.nanoseconds) {
+            value.store(0, std::memory_order_relaxed);
+        }
+        for (std::atomic<uint64_t>& value : totals.counters) {
+            value.store(0, std::memory_order_relaxed);
+        }
+        for (std::atomic<uint64_t>& value : totals.rasterCycles) {
+            value.store(0, std::memory_order_relaxed);
+        }
+        Profiler::instance().registerThread(&totals);
+    }
+
+    ~ThreadSlot() {
+        Profiler::instance().retireThread(&totals);
+    }
+};
+
+Profiler::ThreadTotals& localTotals() {
+    static thread_local ThreadSlot slot;
+    return slot.totals;
+}
+
+}
+
+// Constructor: Empty history, nothing recorded yet
+Profiler::Profiler()
+    : frameStart(std::chrono::steady_clock::now()), frameStartCycles(profileCycles()), newest(HistorySize - 1), frameCount(0) {
+    std::fill(retiredNanoseconds, retiredNanoseconds + StageCount, 0);
+    std::fill(retiredCounters, retiredCounters + CounterCount, 0);
+    std::fill(retiredRasterCycles, retiredRasterCycles + StageCount, 0);
+    std::fill(previousNanoseconds, previousNanoseconds + StageCount, 0);
+    std::fill(previousCounters, previousCounters + CounterCount, 0);
+    std::fill(previousRasterCycles, previousRasterCycles + StageCount, 0);
+}
+
+// Function to get the process-wide profiler
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+// Function to add time to the calling thread's totals; only this thread writes them, so relaxed order is enough
+void Profiler::addTime(ProfileStage stage, std::chrono::steady_clock::duration time) {
+    std::atomic<uint64_t>& total = localTotals().nanoseconds[static_cast<int>(stage)];
+    uint64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+    total.store(total.load(std::memory_order_relaxed) + nanoseconds, std::memory_order_relaxed);
+}
+
+// Function to add events to the calling thread's totals
+void Profiler::addCount(ProfileCounter counter, uint64_t count) {
+    std::atomic<uint64_t>& total = localTotals().counters[static_cast<int>(counter)];
+    total.store(total.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+}
+
+// Function to add cycles of a stage measured inside the calling thread's Rasterization timer
+void Profiler::addRasterCycles(ProfileStage stage, uint64_t cycles) {
+    std::atomic<uint64_t>& total = localTotals().rasterCycles[static_cast<int>(stage)];
+    total.store(total.load(std::memory_order_relaxed) + cycles, std::memory_order_relaxed);
+}
+
+// Function to start collecting a thread's totals
+void Profiler::registerThread(ThreadTotals* totals) {
+    std::lock_guard<std::mutex> lock(mutex);
+    threads.push_back(totals);
+}
+
+// Function to keep an exiting thread's totals in the grand totals
+void Profiler::retireThread(ThreadTotals* totals) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int i = 0; i < StageCount; ++i) {
+        retiredNanoseconds[i] += totals->nanoseconds[i].load(std::memory_order_relaxed);
+    }
+    for (int i = 0; i < CounterCount; ++i) {
+        retiredCounters[i] += totals->counters[i].load(std::memory_order_relaxed);
+    }
+    for (int i = 0; i < StageCount; ++i) {
+        retiredRasterCycles[i] += totals->rasterCycles[i].load(std::memory_order_relaxed);
+    }
+    threads.erase(std::remove(threads.begin(), threads.end(), totals), threads.end());
+}
+
+// Function to add up the totals of every thread, running or exited
+void Profiler::sumTotals(uint64_t nanoseconds[StageCount], uint64_t counters[CounterCount], uint64_t rasterCycles[StageCount]) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::copy(retiredNanoseconds, retiredNanoseconds + StageCount, nanoseconds);
+    std::copy(retiredCounters, retiredCounters + CounterCount, counters);
+    std::copy(retiredRasterCycles, retiredRasterCycles + StageCount, rasterCycles);
+    for (const ThreadTotals* totals : threads) {
+        for (int i = 0; i < StageCount; ++i) {
+            nanoseconds[i] += totals->nanoseconds[i].load(std::memory_order_relaxed);
+        }
+        for (int i = 0; i < CounterCount; ++i) {
+            counters[i] += totals->counters[i].load(std::memory_order_relaxed);
+        }
+        for (int i = 0; i < StageCount; ++i) {
+            rasterCycles[i] += totals->rasterCycles[i].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+// Function to count one call of the counting operator new
+void Profiler::countHeapAllocation() {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Function to read the allocation counter
+uint64_t Profiler::getHeapAllocationCount() {
+    return heapAllocations.load(std::memory_order_relaxed);
+}
+
+// Function to store what was recorded since the previous call as a new frame
+void Profiler::endFrame() {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    uint64_t nowCycles = profileCycles();
+    std::chrono::steady_clock::duration frameTime = now - frameStart;
+    addTime(ProfileStage::Frame, frameTime);
+
+    // Cycles per millisecond over this frame converts the cycles measured in the raster loop
+    double frameMs = std::chrono::duration<double, std::milli>(frameTime).count();
+    double cyclesPerMs = frameMs > 0.0 ? (nowCycles - frameStartCycles) / frameMs : 0.0;
+    frameStart = now;
+    frameStartCycles = nowCycles;
+
+    uint64_t nanoseconds[StageCount];
+    uint64_t counters[CounterCount];
+    uint64_t rasterCycles[StageCount];
+    sumTotals(nanoseconds, counters, rasterCycles);
+    counters[static_cast<int>(ProfileCounter::HeapAllocations)] = getHeapAllocationCount();
+
+    newest = (newest + 1) % HistorySize;
+    frameCount = std::min(frameCount + 1, HistorySize);
+    ProfileFrame& frame = history[newest];
+    for (int i = 0; i < StageCount; ++i) {
+        frame.stageMs[i] = (nanoseconds[i] - previousNanoseconds[i]) * 1e-6;
+        previousNanoseconds[i] = nanoseconds[i];
+    }
+    double& rasterizationMs = frame.stageMs[static_cast<int>(ProfileStage::Rasterization)];
+    for (int i = 0; i < StageCount; ++i) {
+        double ms = cyclesPerMs > 0.0 ? (rasterCycles[i] - previousRasterCycles[i]) / cyclesPerMs : 0.0;
+        previousRasterCycles[i] = rasterCycles[i];
+        frame.stageMs[i] += ms;
+        rasterizationMs -= ms;
+    }
+    rasterizationMs = std::max(rasterizationMs, 0.0);
+    for (int i = 0; i < CounterCount; ++i) {
+        frame.counters[i] = counters[i] - previousCounters[i];
+        previousCounters[i] = counters[i];
+    }
+}
+
+int Profiler::getFrameCount() const {
+    return frameCount;
+}
+
+// Function to look up a frame by age
+const ProfileFrame& Profiler::getFrame(int age) const {
+    return history[(newest - age + HistorySize) % HistorySize];
+}
+
+// Function to copy one stage of the history for plotting
+void Profiler::copyStageHistory(ProfileStage stage, float* values) const {
+    for (int i = 0; i < frameCount; ++i) {
+        values[i] = static_cast<float>(getFrame(frameCount - 1 - i).stageMs[static_cast<int>(stage)]);
+    }
+}
+
+// Function to average one stage over the history
+double Profiler::getAverageMs(ProfileStage stage) const {
+    if (frameCount == 0) {
+        return 0.0;
+    }
+
+    double sum = 0.0;
+    for (int i = 0; i < frameCount; ++i) {
+        sum += getFrame(i).stageMs[static_cast<int>(stage)];
+    }
+    return sum / frameCount;
+}
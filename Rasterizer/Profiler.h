@@ -0,0 +1,196 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define RASTERIZER_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define RASTERIZER_RDTSC 1
+#endif
+
+// Frame profiler, in two parts compiled in separately; by default debug builds get both and release builds neither:
+// - RASTERIZER_COUNTERS compiles in the event counters. The raster loop counts in locals and publishes once per
+//   triangle, so the cost is a few adds per triangle.
+// - RASTERIZER_PROFILE compiles in the stage timers; trace scopes have their own flag, see TraceRecorder.h. Timers
+//   open once per draw, tile or pass, never per quad, so they are meant for profiling builds. Inside a draw the
+//   raster loop also sums the cycle counter around fragment shading and the lazy tile clears into locals and
+//   publishes those once per triangle; endFrame() converts them to time and moves it out of Rasterization into
+//   FragmentShading and Clear.
+// Without either, the PROFILE_* macros below expand to nothing and none of this is referenced by the renderer.
+//
+// Any thread may record. Each thread accumulates into its own totals, so recording never contends; once per frame
+// the main loop calls PROFILE_END_FRAME(), which sums the totals of every thread and stores the difference since the
+// previous frame in a ring buffer. Work finishing on other threads (pipeline stages, presentation) is attributed to
+// the frame during which it finished.
+//
+// Executables that compile in HeapCounter.cpp replace the global operator new by one that counts calls, so every frame
+// also reports how many heap allocations any thread made during it. Steady-state frames of the renderer should make
+// none. The renderer library itself leaves operator new alone.
+
+// Timed parts of a frame. Apart from Frame the stages don't overlap, so on one thread they add up to at most the frame.
+// Forward fragment shading and lazy clears inside a draw are measured in cycles and reported under their own stages.
+enum class ProfileStage {
+    Frame,           // Wall time between two PROFILE_END_FRAME calls
+    DrawSetup,       // Recording and sorting draws
+    VertexShading,   // Transforming vertices to screen space
+    Binning,         // Sorting triangles into tiles (pipelined frames)
+    Rasterization,   // Drawing triangles: coverage, depth test and pixel writes
+    FragmentShading, // Fragment shaders, in the raster loop and in deferred re-shading passes
+    Clear,           // Clearing tiles, lazily as triangles first touch them and when resolving untouched ones
+    Present,         // Copying frames to the presenter and SDL presentation
+    Count
+};
+
+// Events counted per frame
+enum class ProfileCounter {
+    TrianglesIn,     // Triangles submitted to the rasterizer
+    TrianglesCulled, // Triangles dropped before rasterization because they cover no pixel of the target
+    FragmentsShaded, // Fragments that passed the depth test and reached the fragment shader
+    DepthRejects,    // Covered fragments that failed the depth test
+    HeapAllocations, // Calls to operator new on any thread
+    Count
+};
+
+// Everything recorded during one frame
+struct ProfileFrame {
+    double stageMs[static_cast<int>(ProfileStage::Count)];      // Time per stage, summed over threads
+    uint64_t counters[static_cast<int>(ProfileCounter::Count)]; // Count per counter, summed over threads
+};
+
+class Profiler {
+public:
+    static const int StageCount = static_cast<int>(ProfileStage::Count);
+    static const int CounterCount = static_cast<int>(ProfileCounter::Count);
+    static const int HistorySize = 240; // Frames kept in the ring buffer
+
+    // The process-wide profiler
+    static Profiler& instance();
+
+    // Add time to a stage of the calling thread
+    void addTime(ProfileStage stage, std::chrono::steady_clock::duration time);
+
+    // Add events to a counter of the calling thread
+    void addCount(ProfileCounter counter, uint64_t count);
+
+    // Add cycles spent on a stage inside a Rasterization timer of the calling thread; endFrame() moves their time from
+    // Rasterization to the stage
+    void addRasterCycles(ProfileStage stage, uint64_t cycles);
+
+    // Close the current frame and start the next; call from one thread only
+    void endFrame();
+
+    // Number of frames in the ring buffer
+    int getFrameCount() const;
+
+    // A recorded frame; age 0 is the most recent
+    const ProfileFrame& getFrame(int age) const;
+
+    // Time of a stage over the recorded frames, oldest first; writes getFrameCount() values
+    void copyStageHistory(ProfileStage stage, float* values) const;
+
+    // Average time of a stage over the recorded frames
+    double getAverageMs(ProfileStage stage) const;
+
+    // Calls to operator new so far, over all threads; always 0 unless HeapCounter.cpp is linked in
+    static uint64_t getHeapAllocationCount();
+
+    // Count one allocation; called by the operator new of HeapCounter.cpp
+    static void countHeapAllocation();
+
+    // Running totals of one thread, written only by that thread
+    struct ThreadTotals {
+        std::atomic<uint64_t> nanoseconds[StageCount];
+        std::atomic<uint64_t> counters[CounterCount];
+        std::atomic<uint64_t> rasterCycles[StageCount];
+    };
+
+    // Called when a thread starts and stops recording
+    void registerThread(ThreadTotals* totals);
+    void retireThread(ThreadTotals* totals);
+
+private:
+    Profiler();
+
+    // Grand totals of every thread so far
+    void sumTotals(uint64_t nanoseconds[StageCount], uint64_t counters[CounterCount], uint64_t rasterCycles[StageCount]);
+
+    std::mutex mutex;                                  // Guards threads and the retired totals
+    std::vector<ThreadTotals*> threads;                // Threads that recorded and are still running
+    uint64_t retiredNanoseconds[StageCount];           // Totals of threads that exited
+    uint64_t retiredCounters[CounterCount];
+    uint64_t retiredRasterCycles[StageCount];
+    uint64_t previousNanoseconds[StageCount];          // Grand totals at the previous endFrame
+    uint64_t previousCounters[CounterCount];
+    uint64_t previousRasterCycles[StageCount];
+    std::chrono::steady_clock::time_point frameStart;  // Time of the previous endFrame
+    uint64_t frameStartCycles;                         // Cycle counter at the previous endFrame, to convert cycles
+    ProfileFrame history[HistorySize];                 // Ring buffer of frames
+    int newest;                                        // Index of the most recent frame in history
+    int frameCount;                                    // Valid frames in history
+};
+
+// Times its own lifetime into a stage
+class ScopedTimer {
+public:
+    explicit ScopedTimer(ProfileStage stage) : stage(stage), start(std::chrono::steady_clock::now()) {
+    }
+
+    ~ScopedTimer() {
+        Profiler::instance().addTime(stage, std::chrono::steady_clock::now() - start);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    ProfileStage stage;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Cycle counter of the raster loop: the time-stamp counter where there is one, the steady clock's ticks elsewhere.
+// Only differences are used, converted to time by comparing with the steady clock once per frame.
+inline uint64_t profileCycles() {
+#ifdef RASTERIZER_RDTSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// Number of set bits in a 4-bit lane mask
+inline uint64_t laneCount(int mask) {
+    return (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef RASTERIZER_PROFILE
+#define PROFILE_SCOPE(stage) ScopedTimer PROFILE_CONCAT(profileTimer, __LINE__)(stage)
+#define PROFILE_CYCLES() profileCycles()
+#define PROFILE_RASTER_CYCLES(stage, cycles) Profiler::instance().addRasterCycles(stage, cycles)
+#else
+#define PROFILE_SCOPE(stage) ((void)0)
+// Without timers the cycle sums are constant zero and fold away
+#define PROFILE_CYCLES() uint64_t(0)
+#define PROFILE_RASTER_CYCLES(stage, cycles) ((void)sizeof(cycles))
+#endif
+
+#ifdef RASTERIZER_COUNTERS
+#define PROFILE_COUNT(counter, count) Profiler::instance().addCount(counter, count)
+#else
+// The count stays referenced, unevaluated, so counts kept in locals don't warn as unused
+#define PROFILE_COUNT(counter, count) ((void)sizeof(count))
+#endif
+
+#if defined(RASTERIZER_PROFILE) || defined(RASTERIZER_COUNTERS)
+#define PROFILE_END_FRAME() Profiler::instance().endFrame()
+#else
+#define PROFILE_END_FRAME() ((void)0)
+#endif
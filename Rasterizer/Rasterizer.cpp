@@ -1,33 +1,51 @@
-#pragma once
-#include "imgui.h"
-#include "imgui_impl_sdl2.h"
-#include "imgui_impl_sdlrenderer2.h"
-#include "Model.h"
-#include "Renderer.h"
-#include "Setup.h"
-#include "shaderProgram.h"
-#include "TGAImage.h"
-#include "Wireframe.h"
-#include "World.h"
-#include <SDL.h>
-#include <stdio.h>
-
-// Main code  
-int main(int, char**)  
-{     
-   SDL_Window* ui_window;
-   ImGuiIO io;
-   SDL_Renderer* windowRenderer;
-
-   SetupWindow();
-   SetupExampleModel();
-   SetupAll(window_flags, &ui_window, &windowRenderer, io, "Config", 1000, 1000);
-
-   Model head("Model/head.obj", renderer, 1000, 1000);
-
-   renderWindow(ui_window, windowRenderer, io, head);
-  
-   Cleanup(ui_window, windowRenderer);
- 
-   return 0;  
-}
+#include "imgui.h"
+#include "imgui_impl_sdl2.h"
+#include "imgui_impl_sdlrenderer2.h"
+#include "Model.h"
+#include "Renderer.h"
+#include "Setup.h"
+#include "ShaderProgram.h"
+#include "TGAImage.h"
+#include "TraceRecorder.h"
+#include "Wireframe.h"
+#include "World.h"
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Main code  
+int main(int argc, char** argv)  
+{     
+   SDL_Window* ui_window;
+   ImGuiIO io;
+   SDL_Renderer* windowRenderer;
+   int frameLimit = 0;
+
+   // --trace records a Chrome trace from startup, so it includes loading; it can also be toggled in the Config window.
+   // --frames N quits after N frames, so the viewer can run unattended (SDL_VIDEODRIVER=dummy on machines without a display).
+   for (int i = 1; i < argc; ++i)
+   {
+      if (strcmp(argv[i], "--trace") == 0)
+      {
+         TraceRecorder::instance().setEnabled(true);
+      }
+      else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+      {
+         frameLimit = atoi(argv[++i]);
+      }
+   }
+   TRACE_THREAD_NAME("Main");
+
+   SetupWindow();
+   SetupExampleModel();
+   SetupAll(window_flags, &ui_window, &windowRenderer, io, "Config", 1000, 1000);
+
+   Model head("Model/head.obj");
+
+   renderWindow(ui_window, windowRenderer, io, head, frameLimit);
+  
+   Cleanup(ui_window, windowRenderer);
+ 
+   return 0;  
+}
@@ -1,6 +1,4 @@
-#pragma once
-
-#include "readObj.h"
+#include "ReadObj.h"
 
 // Function to read vertices from an OBJ file
 std::vector<Vertex> ObjReader::readVertices(const std::string& filename) {
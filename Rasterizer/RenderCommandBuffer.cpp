@@ -0,0 +1,66 @@
+#include "RenderCommandBuffer.h"
+#include <algorithm>
+#include <cstring>
+
+// Function to reset the buffer for a new frame, keeping its storage
+void RenderCommandBuffer::clear()
+{
+    commands.clear();
+    order.clear();
+    shaders.clear();
+    materials.clear();
+}
+
+// Function to build the sort keys and order the draws
+void RenderCommandBuffer::sort(const Matrix& view)
+{
+    PROFILE_SCOPE(ProfileStage::DrawSetup);
+    order.resize(commands.size());
+    for (size_t i = 0; i < commands.size(); ++i)
+    {
+        const RenderCommand& command = commands[i];
+
+        // Distance in front of the camera of the instance origin; the view looks down -z
+        const Matrix& model = command.modelMatrix;
+        float distance = -(view[2][0] * model[0][3] + view[2][1] * model[1][3] + view[2][2] * model[2][3] + view[2][3]);
+        distance = std::max(distance, 0.0f);
+
+        // Non-negative floats order like their bit patterns, so the distance fills the low 32 bits directly
+        uint32_t depthBits;
+        std::memcpy(&depthBits, &distance, sizeof(depthBits));
+
+        uint64_t key = (static_cast<uint64_t>(command.shaderId) << 48) | (static_cast<uint64_t>(command.materialId) << 32) | depthBits;
+        order[i] = { key, static_cast<uint32_t>(i) };
+    }
+
+    // Ties keep recording order through the index, so the result is deterministic
+    std::sort(order.begin(), order.end());
+}
+
+// Function to draw every command, in sorted order when sort() was called this frame
+void RenderCommandBuffer::execute(const View& view, RenderTarget& target)
+{
+    stateChanges = 0;
+    const RenderCommand* previous = nullptr;
+
+    // One scratch buffer, large enough for every mesh
+    size_t maxVertexCount = 0;
+    for (const RenderCommand& command : commands)
+    {
+        maxVertexCount = std::max(maxVertexCount, command.mesh->getVertices().size());
+    }
+    arena.reset();
+    Vertex* screenCoords = arena.allocate<Vertex>(maxVertexCount);
+
+    for (size_t i = 0; i < commands.size(); ++i)
+    {
+        const RenderCommand& command = getCommand(i);
+        if (previous == nullptr || previous->shader != command.shader || previous->material != command.material)
+        {
+            stateChanges++;
+        }
+        target.setDrawId(static_cast<uint32_t>(i));
+        command.draw(command, view, target, screenCoords);
+        previous = &command;
+    }
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "FrameArena.h"
+#include "Matrix.h"
+#include "Profiler.h"
+#include "Renderer.h"
+#include "Scene.h"
+#include "View.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// One recorded draw: a mesh instance with the state it needs
+struct RenderCommand {
+    const Model* mesh;         // Shared vertex data
+    const Material* material;  // Textures sampled by the shader
+    Matrix modelMatrix;        // Object space to world space
+    shaderProgram* shader;     // Shader object, owned by the caller
+    uint16_t shaderId;         // Dense id of the shader, in recording order
+    uint16_t materialId;       // Dense id of the material, in recording order
+
+    // Raster loop specialized for the shader's type when the command was recorded
+    void (*draw)(const RenderCommand& command, const View& view, RenderTarget& target, Vertex* screenCoords);
+};
+
+// Records draws, sorts them so shader and material changes are rare and each material is drawn front to back,
+// then executes them on a render target. Clear, record, sort and execute once per frame; the buffer keeps its
+// storage between frames.
+class RenderCommandBuffer {
+public:
+    // Forget every recorded draw
+    void clear();
+
+    // Record one draw. Shader may be any shaderProgram type; the command keeps the raster loop compiled for it.
+    template <typename Shader>
+    void record(const Model& mesh, const Material& material, const Matrix& modelMatrix, Shader& shader);
+
+    // Record every instance of a scene with one shader
+    template <typename Shader>
+    void recordScene(const Scene& scene, Shader& shader);
+
+    // Order the draws by shader, then material, then distance from the camera (nearest first)
+    void sort(const Matrix& view);
+
+    // Draw the commands in their current order. Each draw's position in that order is its draw id in the target.
+    void execute(const View& view, RenderTarget& target);
+
+    // Number of recorded draws
+    size_t size() const;
+
+    // The i-th command in execution order
+    const RenderCommand& getCommand(size_t i) const;
+
+    // Number of shader or material changes the last execute() went through
+    int getStateChanges() const;
+
+private:
+    // Dense id of a pointer in a small table, added on first use
+    template <typename T>
+    static uint16_t denseId(std::vector<const T*>& table, const T* value);
+
+    std::vector<RenderCommand> commands;                  // Draws in recording order
+    std::vector<std::pair<uint64_t, uint32_t>> order;     // Sort key and command index
+    std::vector<const shaderProgram*> shaders;            // Shaders seen this frame
+    std::vector<const Material*> materials;               // Materials seen this frame
+    FrameArena arena;                                     // Transformed vertices of execute(), shared by every draw
+    int stateChanges = 0;                                 // Statistic of the last execute()
+};
+
+// Draw a recorded command with the raster loop of its shader type
+template <typename Shader>
+void drawRenderCommand(const RenderCommand& command, const View& view, RenderTarget& target, Vertex* screenCoords)
+{
+    renderInstance(*command.mesh, *command.material, command.modelMatrix, view, *static_cast<Shader*>(command.shader), target,
+        screenCoords);
+}
+
+template <typename T>
+inline uint16_t RenderCommandBuffer::denseId(std::vector<const T*>& table, const T* value)
+{
+    // Frames use a handful of shaders and materials, so a linear search beats hashing
+    for (size_t i = 0; i < table.size(); ++i)
+    {
+        if (table[i] == value)
+        {
+            return static_cast<uint16_t>(i);
+        }
+    }
+    table.push_back(value);
+    return static_cast<uint16_t>(std::min<size_t>(table.size() - 1, 0xFFFF));
+}
+
+template <typename Shader>
+inline void RenderCommandBuffer::record(const Model& mesh, const Material& material, const Matrix& modelMatrix, Shader& shader)
+{
+    RenderCommand command;
+    command.mesh = &mesh;
+    command.material = &material;
+    command.modelMatrix = modelMatrix;
+    command.shader = &shader;
+    command.shaderId = denseId<shaderProgram>(shaders, &shader);
+    command.materialId = denseId(materials, &material);
+    command.draw = &drawRenderCommand<Shader>;
+    commands.push_back(command);
+}
+
+template <typename Shader>
+inline void RenderCommandBuffer::recordScene(const Scene& scene, Shader& shader)
+{
+    PROFILE_SCOPE(ProfileStage::DrawSetup);
+    for (const SceneInstance& instance : scene.getInstances())
+    {
+        record(scene.getMesh(instance.mesh), scene.getMaterial(instance.material), instance.modelMatrix, shader);
+    }
+}
+
+inline size_t RenderCommandBuffer::size() const
+{
+    return commands.size();
+}
+
+inline const RenderCommand& RenderCommandBuffer::getCommand(size_t i) const
+{
+    return commands[order.size() == commands.size() ? order[i].second : i];
+}
+
+inline int RenderCommandBuffer::getStateChanges() const
+{
+    return stateChanges;
+}
@@ -0,0 +1,116 @@
+#include "RenderTarget.h"
+#include "Profiler.h"
+#include "TGAImage.h"
+#include <algorithm>
+
+// Constructor: Allocates both attachments; the first clear decides the color
+RenderTarget::RenderTarget(int width, int height, DepthFormat depthFormat, bool reversedZ)
+    : width(0), height(0), stride(0), clearValue(0), colorTiles(width, height), depth(width, height, depthFormat, reversedZ),
+      visibilityEnabled(false), drawId(0) {
+    resize(width, height);
+}
+
+// Function to reallocate the attachments for a new size
+void RenderTarget::resize(int newWidth, int newHeight) {
+    if (newWidth == width && newHeight == height) {
+        return;
+    }
+
+    width = newWidth;
+    height = newHeight;
+    stride = newWidth;
+    // Every tile is stale after the reset, so the pages are left for the first clear of each tile to place
+    color.allocate(static_cast<size_t>(stride) * height);
+    colorTiles.reset(width, height);
+    if (visibilityEnabled) {
+        visibility.allocate(color.size());
+    }
+    if (depth.getWidth() != width || depth.getHeight() != height) {
+        DepthFunc func = depth.getDepthFunc();
+        depth = DepthBuffer(width, height, depth.getFormat(), depth.isReversedZ());
+        depth.setDepthFunc(func);
+    }
+}
+
+// Function to start a new frame: both attachments are cleared lazily, tile by tile
+void RenderTarget::clear(Color clearColor) {
+    clearValue = packColor(clearColor);
+    colorTiles.clear();
+    depth.clear();
+}
+
+// Function to initialize the tiles a draw is about to touch. Called once per triangle, so it isn't timed on its own; the
+// raster loop counts its cycles as Clear.
+void RenderTarget::prepare(int minX, int minY, int maxX, int maxY) {
+    colorTiles.touch(minX, minY, maxX, maxY, [this](int x0, int y0, int x1, int y1) {
+        fillClearColor(x0, y0, x1, y1);
+    });
+    depth.prepare(minX, minY, maxX, maxY);
+}
+
+// Function to clear the color tiles that were never drawn to
+void RenderTarget::resolve() {
+    if (width > 0 && height > 0) {
+        resolve({ 0, 0, width - 1, height - 1 });
+    }
+}
+
+// Function to clear the color tiles of one rectangle that were never drawn to
+void RenderTarget::resolve(const PixelRect& rect) {
+    PROFILE_SCOPE(ProfileStage::Clear);
+    colorTiles.touch(rect.minX, rect.minY, rect.maxX, rect.maxY, [this](int x0, int y0, int x1, int y1) {
+        fillClearColor(x0, y0, x1, y1);
+    });
+}
+
+// Function to save the color attachment; row 0 is the top of the image, as in the file
+bool RenderTarget::writeTGA(const char* filename) const {
+    TGAImage image(width, height, TGAImage::RGB);
+    for (int y = 0; y < height; ++y) {
+        const uint32_t* row = color.data() + static_cast<size_t>(y) * stride;
+        for (int x = 0; x < width; ++x) {
+            uint32_t pixel = row[x];
+            image.set(x, y, TGAColor((pixel >> 16) & 0xFF, (pixel >> 8) & 0xFF, pixel & 0xFF, 255));
+        }
+    }
+    return image.write_tga_file(filename);
+}
+
+// Function to add or drop the visibility attachment; a new attachment starts empty
+void RenderTarget::setVisibilityEnabled(bool enabled) {
+    if (enabled == visibilityEnabled) {
+        return;
+    }
+
+    visibilityEnabled = enabled;
+    if (enabled) {
+        visibility.assign(color.size(), { VisibilitySample::NoDraw, 0.0f, 0.0f });
+    }
+    else {
+        visibility.release();
+    }
+}
+
+// Function to fill one rectangle of the color attachment, and of the visibility attachment if there is one
+void RenderTarget::fillClearColor(int x0, int y0, int x1, int y1) {
+    for (int y = y0; y <= y1; ++y) {
+        uint32_t* row = color.data() + static_cast<size_t>(y) * stride;
+        std::fill(row + x0, row + x1 + 1, clearValue);
+    }
+
+    if (visibilityEnabled) {
+        for (int y = y0; y <= y1; ++y) {
+            VisibilitySample* row = visibility.data() + static_cast<size_t>(y) * stride;
+            std::fill(row + x0, row + x1 + 1, VisibilitySample{ VisibilitySample::NoDraw, 0.0f, 0.0f });
+        }
+    }
+}
+
+// Function to build the viewport transform: the model covers the central 3/4 of the target and y is flipped
+// so that row 0 is the top of the image
+Matrix RenderTarget::getViewport() const {
+    Matrix m = viewport(width / 8, height / 8, width * 3 / 4, height * 3 / 4);
+    m[1][1] = -m[1][1];
+    m[1][3] = height - m[1][3];
+    return m;
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "DepthBuffer.h"
+#include "FirstTouchBuffer.h"
+#include "Matrix.h"
+#include "Structs.h"
+#include "TileClearState.h"
+#include <cstdint>
+
+// Inclusive rectangle of pixels
+struct PixelRect {
+    int minX;
+    int minY;
+    int maxX;
+    int maxY;
+};
+
+// Visible surface at one pixel: the draw that produced it and the texture coordinates it was shaded with.
+// Enough to run the fragment shader again without rasterizing (see DeferredShading.h).
+struct VisibilitySample {
+    static const uint32_t NoDraw = 0xFFFFFFFFu; // Draw id of pixels no draw covered
+
+    uint32_t draw; // Draw id set on the target when the pixel was written
+    float u;       // Interpolated texture coordinates
+    float v;
+};
+
+// Everything a draw writes to: a color attachment, a depth attachment and the viewport mapping onto them.
+// Nothing here is global, so several targets can be rendered at the same time from different threads
+// as long as each thread uses its own target and shader.
+// Allocating a target writes none of its pixels: a tile's color and depth are first written by the thread that
+// clears it (see prepare and resolve), which on a NUMA machine places the tile's rows on that thread's node.
+class RenderTarget {
+public:
+    // Constructor: allocates color and depth attachments of the given size
+    RenderTarget(int width, int height, DepthFormat depthFormat = DepthFormat::Float32, bool reversedZ = false);
+
+    // Reallocate both attachments; keeps the depth format, convention and function
+    void resize(int width, int height);
+
+    // Clear color and depth. Only marks the tiles stale; see prepare()
+    void clear(Color clearColor);
+
+    // Initialize the stale color and depth tiles overlapping a pixel rectangle (inclusive, inside the target)
+    void prepare(int minX, int minY, int maxX, int maxY);
+
+    // Fill every color tile no draw touched since the last clear, so the whole color attachment is readable
+    void resolve();
+
+    // Fill the color tiles overlapping a pixel rectangle (inclusive, inside the target) that no draw touched
+    void resolve(const PixelRect& rect);
+
+    // Store a color at a pixel offset (see getStride)
+    void setPixel(int offset, Color color);
+
+    // Packed color at a pixel offset
+    uint32_t getPixel(int offset) const;
+
+    // Matrix mapping normalized device coordinates to pixels of this target, with y pointing down
+    Matrix getViewport() const;
+
+    int getWidth() const;
+
+    int getHeight() const;
+
+    // Distance between rows of the color attachment, in pixels
+    int getStride() const;
+
+    // Color attachment, one SDL_PIXELFORMAT_ARGB8888 value per pixel, getStride() pixels per row.
+    // Tiles not touched since the last clear hold undefined values until resolve().
+    const uint32_t* getColorData() const;
+
+    // Write the color attachment as an RGB TGA file; call resolve() first. Returns false if the file can't be written.
+    bool writeTGA(const char* filename) const;
+
+    DepthBuffer& getDepthBuffer();
+
+    const DepthBuffer& getDepthBuffer() const;
+
+    // Add or drop the visibility attachment. When present, draws record the visible surface of every pixel they write
+    // and clears reset it along with the color.
+    void setVisibilityEnabled(bool enabled);
+
+    // Visibility attachment, getStride() samples per row; nullptr when disabled
+    const VisibilitySample* getVisibilityData() const;
+
+    // Store the visible surface at a pixel offset; requires the visibility attachment
+    void setVisibility(int offset, const VisibilitySample& sample);
+
+    // Draw id recorded in the visibility attachment by the following draws
+    void setDrawId(uint32_t drawId);
+
+    uint32_t getDrawId() const;
+
+private:
+    // Fill a pixel rectangle (inclusive) of the color attachment with the clear color
+    void fillClearColor(int x0, int y0, int x1, int y1);
+
+    int width;                   // Width in pixels
+    int height;                  // Height in pixels
+    int stride;                  // Color row pitch in pixels
+    uint32_t clearValue;         // Packed clear color of the current frame
+    FirstTouchBuffer<uint32_t> color; // Color attachment
+    TileClearState colorTiles;   // Color tiles initialized since the last clear
+    DepthBuffer depth;           // Depth attachment
+    bool visibilityEnabled;      // True when the visibility attachment is kept
+    FirstTouchBuffer<VisibilitySample> visibility; // Visibility attachment, cleared with the color tiles
+    uint32_t drawId;             // Draw id recorded by the current draw
+};
+
+// Pack a color as SDL_PIXELFORMAT_ARGB8888
+inline uint32_t packColor(Color color) {
+    return (static_cast<uint32_t>(color.a) << 24) | (static_cast<uint32_t>(color.r) << 16) |
+        (static_cast<uint32_t>(color.g) << 8) | color.b;
+}
+
+inline void RenderTarget::setPixel(int offset, Color value) {
+    color[offset] = packColor(value);
+}
+
+inline uint32_t RenderTarget::getPixel(int offset) const {
+    return color[offset];
+}
+
+inline int RenderTarget::getWidth() const {
+    return width;
+}
+
+inline int RenderTarget::getHeight() const {
+    return height;
+}
+
+inline int RenderTarget::getStride() const {
+    return stride;
+}
+
+inline const uint32_t* RenderTarget::getColorData() const {
+    return color.data();
+}
+
+inline const VisibilitySample* RenderTarget::getVisibilityData() const {
+    return visibilityEnabled ? visibility.data() : nullptr;
+}
+
+inline void RenderTarget::setVisibility(int offset, const VisibilitySample& sample) {
+    visibility[offset] = sample;
+}
+
+inline void RenderTarget::setDrawId(uint32_t newDrawId) {
+    drawId = newDrawId;
+}
+
+inline uint32_t RenderTarget::getDrawId() const {
+    return drawId;
+}
+
+inline DepthBuffer& RenderTarget::getDepthBuffer() {
+    return depth;
+}
+
+inline const DepthBuffer& RenderTarget::getDepthBuffer() const {
+    return depth;
+}
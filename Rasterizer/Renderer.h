@@ -1,18 +1,432 @@
-#pragma once
-
-#include "Model.h"
-#include "ShaderProgram.h"
-#include "Structs.h"
-#include <SDL.h>
-
-// Render a model using the given shader
-void renderModel(Model& model, shaderProgram& shader);
-
-// Render a triangle using the given shader
-void renderTriangle(Vertex screenCoord[3], shaderProgram& shader, int * zbuffer);
-
-// Render a wireframe of a model
-void renderWireframe(Model& model);
-
-// Render a wireframe of a model with a specific color
-void renderLine(int x0, int y0, int x1, int y1);
\ No newline at end of file
+#pragma once
+
+#include "FrameArena.h"
+#include "JobSystem.h"
+#include "Model.h"
+#include "Profiler.h"
+#include "RenderTarget.h"
+#include "Scene.h"
+#include "ShaderProgram.h"
+#include "Structs.h"
+#include "TraceRecorder.h"
+#include "View.h"
+#include <algorithm>
+#include <vector>
+
+// Render a model into a render target using the given shader. Shader is any type with the shaderProgram members (uniforms,
+// transformVertex and fragmentShaderQuad); each type gets its own raster loop, fully inlined when the shader type is final.
+// The target is not cleared, so several models drawn into one target share its depth buffer. Only the target and the
+// shader are written, so different threads may render into different targets with their own shaders.
+template <typename Shader>
+void renderModel(const Model& model, Shader& shader, RenderTarget& target);
+
+// Render a model through the runtime shader interface (virtual calls, any shaderProgram subclass)
+void renderModel(const Model& model, shaderProgram& shader, RenderTarget& target);
+
+// Render every instance of a scene into a render target as seen from a view. Meshes big enough to split have their
+// vertices transformed as jobs of jobs.
+template <typename Shader>
+void renderScene(const Scene& scene, const View& view, Shader& shader, RenderTarget& target, JobSystem& jobs = JobSystem::instance());
+
+// Render a scene through the runtime shader interface
+void renderScene(const Scene& scene, const View& view, shaderProgram& shader, RenderTarget& target);
+
+// Render one instance of a mesh. The shared vertices are transformed once per instance into screenCoords,
+// scratch space for at least the mesh's vertex count that the caller reuses between instances.
+template <typename Shader>
+void renderInstance(const Model& model, const Material& material, const Matrix& modelMatrix, const View& view, Shader& shader,
+    RenderTarget& target, Vertex* screenCoords, JobSystem& jobs = JobSystem::instance());
+
+// Render a scene from many views at once, views[i] into targets[i], as for turntables and dataset generation. Each view
+// is one job that clears its target to clearColor, draws like renderScene on one thread and resolves, so the views
+// spread over the threads of jobs and throughput grows with the core count. Meshes and materials are shared by every view and only
+// read; each view draws with its own copy of shader into its own target. targets must hold exactly one target per view
+// (std::invalid_argument otherwise, before anything is drawn); each keeps its own size and depth setup. Every image is
+// identical to renderScene with the same view.
+template <typename Shader>
+void renderViews(const Scene& scene, const std::vector<View>& views, const Shader& shader, Color clearColor,
+    std::vector<RenderTarget>& targets, JobSystem& jobs = JobSystem::instance());
+
+// Render a model in a material, without a model transform as renderModel draws it, from many views at once; see the
+// scene version
+template <typename Shader>
+void renderViews(const Model& model, const Material& material, const std::vector<View>& views, const Shader& shader,
+    Color clearColor, std::vector<RenderTarget>& targets, JobSystem& jobs = JobSystem::instance());
+
+// Throw std::invalid_argument unless there is exactly one target per view
+void checkViewTargets(const std::vector<View>& views, const std::vector<RenderTarget>& targets);
+
+// Vertices per job when transforming a mesh; smaller meshes are transformed on the calling thread
+const size_t VertexJobGrain = 4096;
+
+// Transform the shared vertices of a mesh to screen space with the shader's current uniforms; writes one screen
+// coordinate per vertex. Large meshes are split into jobs that call transformVertex on the same shader, so it must
+// only read the shader's uniforms.
+template <typename Shader>
+void transformVertices(const Model& model, Shader& shader, Vertex* screenCoords, JobSystem& jobs = JobSystem::instance());
+
+// Arena of the calling thread for the scratch space of renderModel and renderScene. Each of those calls resets it
+// when it starts, so nothing allocated from it may be kept across them.
+FrameArena& immediateArena();
+
+// Job system of one thread, which runs all its jobs on the caller
+JobSystem& inlineJobs();
+
+// Bounding box of a screen-space triangle clipped to a width x height target; false when nothing is left
+bool triangleBounds(const Vertex screenCoord[3], int width, int height, PixelRect& bounds);
+
+// Render a triangle using the given shader; false when it covers no pixel of the target and was culled. Triangle
+// counters are left to the caller, which publishes them once per draw.
+template <typename Shader>
+bool renderTriangle(Vertex screenCoord[3], Shader& shader, RenderTarget& target);
+
+// Render the part of a triangle inside a rectangle of pixels (which must lie inside the target). drawId is recorded in the
+// visibility attachment; passing it instead of setting it on the target lets threads share a target, one rectangle each.
+template <typename Shader>
+void renderTriangle(Vertex screenCoord[3], Shader& shader, RenderTarget& target, const PixelRect& scissor, uint32_t drawId);
+
+// Rasterize the part of a triangle inside a rectangle into a target whose depth buffer has a known format.
+// Every pixel gets the same coverage, depth and shading whatever rectangle it is rasterized through.
+template <DepthFormat Format, typename Shader>
+void rasterizeTriangle(Vertex screenCoord[3], Shader& shader, RenderTarget& target, const PixelRect& scissor, uint32_t drawId);
+
+// Render a wireframe of a model
+void renderWireframe(const Model& model, RenderTarget& target);
+
+// Render a line into the target with a specific color
+void renderLine(RenderTarget& target, int x0, int y0, int x1, int y1, Color color);
+
+// Function to render a 3D model using a texture and a shader program
+template <typename Shader>
+void renderModel(const Model& model, Shader& shader, RenderTarget& target)
+{
+	FrameArena& arena = immediateArena();
+	arena.reset();
+	Vertex* screenCoords = arena.allocate<Vertex>(model.getVertices().size());
+	renderInstance(model, *shader.uniform_Material, Matrix::identity(4), currentView(), shader, target, screenCoords);
+}
+
+// Function to render all instances of a scene, sharing one scratch buffer between them
+template <typename Shader>
+void renderScene(const Scene& scene, const View& view, Shader& shader, RenderTarget& target, JobSystem& jobs)
+{
+	const Material* sceneMaterial = shader.uniform_Material;
+	FrameArena& arena = immediateArena();
+	arena.reset();
+	Vertex* screenCoords = arena.allocate<Vertex>(scene.getMaxVertexCount());
+
+	for (const SceneInstance& instance : scene.getInstances())
+	{
+		renderInstance(scene.getMesh(instance.mesh), scene.getMaterial(instance.material), instance.modelMatrix, view, shader, target,
+			screenCoords, jobs);
+	}
+
+	// Leave the shader's material as the caller set it
+	shader.uniform_Material = sceneMaterial;
+}
+
+// Function to render one placement of a shared mesh
+template <typename Shader>
+void renderInstance(const Model& model, const Material& material, const Matrix& modelMatrix, const View& view, Shader& shader,
+    RenderTarget& target, Vertex* screenCoords, JobSystem& jobs)
+{
+	shader.setTransforms(view.projection * view.viewMatrix, modelMatrix, target.getViewport(), view.lightDirection);
+	shader.uniform_Material = &material;
+
+	// Retrieve model data: faces and texture coordinates
+	const std::vector<Face>& faces = model.getFaces();
+	const std::vector<TexCoord>& texCords = model.getTexCoords();
+
+	// Transform every shared vertex once; faces then only gather their corners
+	transformVertices(model, shader, screenCoords, jobs);
+
+	Vertex screenCoord[3];
+	TRACE_SCOPE("Raster draw");
+	PROFILE_SCOPE(ProfileStage::Rasterization);
+
+	// Counted here and published once for the draw
+	uint64_t culled = 0;
+
+	// Iterate over each face of the model
+	for (const Face& face : faces)
+	{
+		// Gather the transformed corners and their texture coordinates (assuming triangular faces)
+		for (int i = 0; i < 3; ++i)
+		{
+			screenCoord[i] = screenCoords[face.vertexIndex[i]];
+			shader.uvCoord[i] = texCords[face.texCoordIndex[i]];
+		}
+
+		// Render the triangle formed by the three screen coordinates
+		if (!renderTriangle(screenCoord, shader, target))
+		{
+			++culled;
+		}
+	}
+
+	PROFILE_COUNT(ProfileCounter::TrianglesIn, faces.size());
+	PROFILE_COUNT(ProfileCounter::TrianglesCulled, culled);
+}
+
+// Function to render every view of a scene as its own job. A view's scratch vertices come from the arena of the thread
+// running it, which renderScene resets, so views on different threads share nothing they write. The view's vertices are
+// transformed inline: a view waiting on vertex jobs could take another view's job meanwhile, which would reset the
+// arena under it, and the views keep every thread busy anyway.
+template <typename Shader>
+void renderViews(const Scene& scene, const std::vector<View>& views, const Shader& shader, Color clearColor,
+    std::vector<RenderTarget>& targets, JobSystem& jobs)
+{
+	static_assert(isCopyableShader<Shader>, "Shader is copied by value, so it must be a final shader type such as PhongShader, not the shaderProgram interface");
+	TRACE_SCOPE("Render views");
+	checkViewTargets(views, targets);
+	jobs.parallelFor(views.size(), 1, [&scene, &views, &shader, clearColor, &targets](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			TRACE_SCOPE("View");
+			Shader viewShader = shader;
+			targets[i].clear(clearColor);
+			renderScene(scene, views[i], viewShader, targets[i], inlineJobs());
+			targets[i].resolve();
+		}
+	});
+}
+
+// Function to render every view of a single model as its own job
+template <typename Shader>
+void renderViews(const Model& model, const Material& material, const std::vector<View>& views, const Shader& shader,
+    Color clearColor, std::vector<RenderTarget>& targets, JobSystem& jobs)
+{
+	static_assert(isCopyableShader<Shader>, "Shader is copied by value, so it must be a final shader type such as PhongShader, not the shaderProgram interface");
+	TRACE_SCOPE("Render views");
+	checkViewTargets(views, targets);
+	const Matrix modelMatrix = Matrix::identity(4);
+	jobs.parallelFor(views.size(), 1, [&model, &material, &views, &shader, clearColor, &targets, &modelMatrix](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			TRACE_SCOPE("View");
+			Shader viewShader = shader;
+			FrameArena& arena = immediateArena();
+			arena.reset();
+			Vertex* screenCoords = arena.allocate<Vertex>(model.getVertices().size());
+			targets[i].clear(clearColor);
+			renderInstance(model, material, modelMatrix, views[i], viewShader, targets[i], screenCoords, inlineJobs());
+			targets[i].resolve();
+		}
+	});
+}
+
+// Function to transform every vertex of a mesh once, in ranges of VertexJobGrain vertices
+template <typename Shader>
+void transformVertices(const Model& model, Shader& shader, Vertex* screenCoords, JobSystem& jobs)
+{
+	const std::vector<Vertex>& vertices = model.getVertices();
+	jobs.parallelFor(vertices.size(), VertexJobGrain, [&vertices, &shader, screenCoords](size_t begin, size_t end)
+	{
+		PROFILE_SCOPE(ProfileStage::VertexShading);
+		TRACE_SCOPE("Vertex");
+		for (size_t i = begin; i < end; ++i)
+		{
+			screenCoords[i] = shader.transformVertex(vertices[i]);
+		}
+	});
+}
+
+// Function to find the pixels a triangle can cover
+inline bool triangleBounds(const Vertex screenCoord[3], int width, int height, PixelRect& bounds)
+{
+    bounds.minX = std::max(0, static_cast<int>(std::min({ screenCoord[0].x, screenCoord[1].x, screenCoord[2].x })));
+    bounds.maxX = std::min(width - 1, static_cast<int>(std::max({ screenCoord[0].x, screenCoord[1].x, screenCoord[2].x })));
+    bounds.minY = std::max(0, static_cast<int>(std::min({ screenCoord[0].y, screenCoord[1].y, screenCoord[2].y })));
+    bounds.maxY = std::min(height - 1, static_cast<int>(std::max({ screenCoord[0].y, screenCoord[1].y, screenCoord[2].y })));
+    return bounds.minX <= bounds.maxX && bounds.minY <= bounds.maxY;
+}
+
+// Function to render a triangle on the screen, clipped to the target
+template <typename Shader>
+bool renderTriangle(Vertex screenCoord[3], Shader& shader, RenderTarget& target)
+{
+    PixelRect bounds;
+    if (!triangleBounds(screenCoord, target.getWidth(), target.getHeight(), bounds))
+    {
+        return false;
+    }
+    renderTriangle(screenCoord, shader, target, bounds, target.getDrawId());
+    return true;
+}
+
+// Function to render part of a triangle, selecting the raster loop for the depth format
+template <typename Shader>
+void renderTriangle(Vertex screenCoord[3], Shader& shader, RenderTarget& target, const PixelRect& scissor, uint32_t drawId)
+{
+    switch (target.getDepthBuffer().getFormat())
+    {
+    case DepthFormat::Float32:
+        rasterizeTriangle<DepthFormat::Float32>(screenCoord, shader, target, scissor, drawId);
+        break;
+    case DepthFormat::Unorm24:
+        rasterizeTriangle<DepthFormat::Unorm24>(screenCoord, shader, target, scissor, drawId);
+        break;
+    case DepthFormat::Unorm16:
+        rasterizeTriangle<DepthFormat::Unorm16>(screenCoord, shader, target, scissor, drawId);
+        break;
+    }
+}
+
+// Function to rasterize a triangle, shading 2x2 quads of fragments at a time
+template <DepthFormat Format, typename Shader>
+void rasterizeTriangle(Vertex screenCoord[3], Shader& shader, RenderTarget& target, const PixelRect& scissor, uint32_t drawId)
+{
+    DepthBuffer& depthBuffer = target.getDepthBuffer();
+    const int width = target.getWidth();
+    const int stride = target.getStride();
+
+    // Clip the bounding box of the triangle to the scissor rectangle
+    PixelRect bounds;
+    if (!triangleBounds(screenCoord, width, target.getHeight(), bounds))
+    {
+        return;
+    }
+    int minX = std::max(bounds.minX, scissor.minX);
+    int maxX = std::min(bounds.maxX, scissor.maxX);
+    int minY = std::max(bounds.minY, scissor.minY);
+    int maxY = std::min(bounds.maxY, scissor.maxY);
+    if (minX > maxX || minY > maxY)
+    {
+        return;
+    }
+
+    // Lazily clear the color and depth tiles this triangle can touch
+    uint64_t clearStart = PROFILE_CYCLES();
+    target.prepare(minX, minY, maxX, maxY);
+    PROFILE_RASTER_CYCLES(ProfileStage::Clear, PROFILE_CYCLES() - clearStart);
+
+    // Quads start on even coordinates so neighbouring triangles share the same quad grid
+    int quadMinX = minX & ~1;
+    int quadMinY = minY & ~1;
+
+    // Precompute values for barycentric coordinates
+    float denom = (screenCoord[1].y - screenCoord[2].y) * (screenCoord[0].x - screenCoord[2].x) +
+        (screenCoord[2].x - screenCoord[1].x) * (screenCoord[0].y - screenCoord[2].y);
+    float invDenom = 1.0f / denom;
+
+    // Barycentric coordinate gradients
+    float dx_baryX = (screenCoord[1].y - screenCoord[2].y) * invDenom;
+    float dy_baryX = (screenCoord[2].x - screenCoord[1].x) * invDenom;
+    float dx_baryY = (screenCoord[2].y - screenCoord[0].y) * invDenom;
+    float dy_baryY = (screenCoord[0].x - screenCoord[2].x) * invDenom;
+
+    // Barycentric coordinates are evaluated from the pixel position relative to vertex 2 rather than stepped from the
+    // corner of the rectangle, so a pixel gets bit-identical values whichever rectangle (tile) it is rasterized through
+    const float originX = 0.5f - screenCoord[2].x;
+    const float originY = 0.5f - screenCoord[2].y;
+
+    // Per-lane offsets of the barycentric coordinates inside a quad
+    const int laneX[4] = { 0, 1, 0, 1 };
+    const int laneY[4] = { 0, 0, 1, 1 };
+    float laneBaryX[4];
+    float laneBaryY[4];
+    for (int lane = 0; lane < 4; ++lane)
+    {
+        laneBaryX[lane] = laneX[lane] * dx_baryX + laneY[lane] * dy_baryX;
+        laneBaryY[lane] = laneX[lane] * dx_baryY + laneY[lane] * dy_baryY;
+    }
+
+    // Initialize the colors to white
+    Color colors[4] = { { 255, 255, 255, 255 }, { 255, 255, 255, 255 }, { 255, 255, 255, 255 }, { 255, 255, 255, 255 } };
+
+    // Precompute depth values for the triangle's vertices (linear, so converting before interpolation is exact)
+    float z0 = depthBuffer.toDepth(screenCoord[0].z);
+    float z1 = depthBuffer.toDepth(screenCoord[1].z);
+    float z2 = depthBuffer.toDepth(screenCoord[2].z);
+
+    // Deferred re-shading needs the visible surface of every pixel when the target keeps it
+    const bool recordVisibility = target.getVisibilityData() != nullptr;
+
+    FragmentQuad quad;
+    float z[4];
+    int index[4];
+
+    // Counted here and published once for the triangle
+    uint64_t depthRejects = 0;
+    uint64_t fragmentsShaded = 0;
+    uint64_t shadingCycles = 0;
+
+    // Iterate through each 2x2 quad in the bounding box
+    for (int y = quadMinY; y <= maxY; y += 2) {
+        float rowBaryX = (y + originY) * dy_baryX;
+        float rowBaryY = (y + originY) * dy_baryY;
+
+        for (int x = quadMinX; x <= maxX; x += 2)
+        {
+            // Barycentric coordinates at the quad's top-left pixel
+            float baryX = (x + originX) * dx_baryX + rowBaryX;
+            float baryY = (x + originX) * dx_baryY + rowBaryY;
+
+            quad.mask = 0;
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                int px = x + laneX[lane];
+                int py = y + laneY[lane];
+
+                // Compute the barycentric coordinates of this lane
+                quad.baryX[lane] = baryX + laneBaryX[lane];
+                quad.baryY[lane] = baryY + laneBaryY[lane];
+                quad.baryZ[lane] = 1.0f - quad.baryX[lane] - quad.baryY[lane];
+
+                // Check if the point is inside the triangle and on the clipped bounding box
+                if (quad.baryX[lane] >= 0 && quad.baryY[lane] >= 0 && quad.baryZ[lane] >= 0 &&
+                    px >= minX && px <= maxX && py >= minY && py <= maxY)
+                {
+                    // Compute the interpolated z-value and perform the depth test
+                    z[lane] = quad.baryX[lane] * z0 + quad.baryY[lane] * z1 + quad.baryZ[lane] * z2;
+                    index[lane] = py * width + px;
+                    if (depthBuffer.test<Format>(index[lane], z[lane]))
+                    {
+                        quad.mask |= 1 << lane;
+                    }
+                    else
+                    {
+                        ++depthRejects;
+                    }
+                }
+            }
+
+            if (quad.mask)
+            {
+                // Execute the fragment shader for the whole quad
+                uint64_t shadingStart = PROFILE_CYCLES();
+                int written = shader.fragmentShaderQuad(quad, colors);
+                shadingCycles += PROFILE_CYCLES() - shadingStart;
+                fragmentsShaded += laneCount(quad.mask);
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    if (written & (1 << lane))
+                    {
+                        // Update the z-buffer and set the pixel color
+                        depthBuffer.write<Format>(index[lane], z[lane]);
+                        int offset = (y + laneY[lane]) * stride + x + laneX[lane];
+                        target.setPixel(offset, colors[lane]);
+
+                        if (recordVisibility)
+                        {
+                            // Same expression, in the same order, as the fragment shader's interpolation
+                            VisibilitySample sample;
+                            sample.draw = drawId;
+                            sample.u = quad.baryX[lane] * shader.uvCoord[0].u + quad.baryY[lane] * shader.uvCoord[1].u +
+                                quad.baryZ[lane] * shader.uvCoord[2].u;
+                            sample.v = quad.baryX[lane] * shader.uvCoord[0].v + quad.baryY[lane] * shader.uvCoord[1].v +
+                                quad.baryZ[lane] * shader.uvCoord[2].v;
+                            target.setVisibility(offset, sample);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    PROFILE_COUNT(ProfileCounter::DepthRejects, depthRejects);
+    PROFILE_COUNT(ProfileCounter::FragmentsShaded, fragmentsShaded);
+    PROFILE_RASTER_CYCLES(ProfileStage::FragmentShading, shadingCycles);
+}
@@ -0,0 +1,64 @@
+#include "Scene.h"
+#include <algorithm>
+
+// Constructor: Starts without meshes, materials or instances
+Scene::Scene() : revision(0) {
+}
+
+// Function to register a mesh shared by instances
+int Scene::addMesh(const Model& mesh) {
+    meshes.push_back(&mesh);
+    ++revision;
+    return static_cast<int>(meshes.size()) - 1;
+}
+
+// Function to register a material shared by instances
+int Scene::addMaterial(const Material& material) {
+    materials.push_back(&material);
+    ++revision;
+    return static_cast<int>(materials.size()) - 1;
+}
+
+// Function to place a mesh in the scene
+int Scene::addInstance(int mesh, int material, const Matrix& modelMatrix) {
+    instances.push_back({ mesh, material, modelMatrix });
+    ++revision;
+    return static_cast<int>(instances.size()) - 1;
+}
+
+// Function to move an instance
+void Scene::setModelMatrix(int instance, const Matrix& modelMatrix) {
+    instances[instance].modelMatrix = modelMatrix;
+    ++revision;
+}
+
+// Function to remove every instance
+void Scene::clearInstances() {
+    instances.clear();
+    ++revision;
+}
+
+const Model& Scene::getMesh(int mesh) const {
+    return *meshes[mesh];
+}
+
+const Material& Scene::getMaterial(int material) const {
+    return *materials[material];
+}
+
+const std::vector<SceneInstance>& Scene::getInstances() const {
+    return instances;
+}
+
+uint64_t Scene::getRevision() const {
+    return revision;
+}
+
+// Function to find the scratch size needed to transform any registered mesh
+size_t Scene::getMaxVertexCount() const {
+    size_t count = 0;
+    for (const Model* mesh : meshes) {
+        count = std::max(count, mesh->getVertices().size());
+    }
+    return count;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Material.h"
+#include "Matrix.h"
+#include "Model.h"
+#include <cstdint>
+#include <vector>
+
+// One placement of a mesh in the scene. Instances refer to meshes and materials by index,
+// so any number of them share the same vertex data and textures.
+struct SceneInstance {
+    int mesh;           // Index returned by Scene::addMesh
+    int material;       // Index returned by Scene::addMaterial
+    Matrix modelMatrix; // Object space to world space
+};
+
+// A list of mesh instances to draw together. The scene does not own meshes or materials;
+// they must outlive it.
+class Scene {
+public:
+    // Constructor: an empty scene at revision 0
+    Scene();
+
+    // Register a mesh and return its index
+    int addMesh(const Model& mesh);
+
+    // Register a material and return its index
+    int addMaterial(const Material& material);
+
+    // Place a registered mesh with a registered material and return the instance index
+    int addInstance(int mesh, int material, const Matrix& modelMatrix);
+
+    // Move an existing instance
+    void setModelMatrix(int instance, const Matrix& modelMatrix);
+
+    // Remove every instance; registered meshes and materials are kept
+    void clearInstances();
+
+    const Model& getMesh(int mesh) const;
+
+    const Material& getMaterial(int material) const;
+
+    const std::vector<SceneInstance>& getInstances() const;
+
+    // Incremented by every change to the scene, so a renderer can tell whether its last frame is still valid
+    uint64_t getRevision() const;
+
+    // Largest vertex count of the registered meshes, the scratch space one instance needs
+    size_t getMaxVertexCount() const;
+
+private:
+    std::vector<const Model*> meshes;       // Shared vertex data
+    std::vector<const Material*> materials; // Shared textures
+    std::vector<SceneInstance> instances;   // Per-instance placement
+    uint64_t revision;                      // Number of changes so far
+};
@@ -1,215 +1,552 @@
-#pragma once
-#include "Setup.h"
-
-// Function to setup SDL and initialize video
-bool SetupWindow()
-{
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_GAMECONTROLLER) != 0)
-    {
-        printf("Error: SDL_Init failed: %s\n", SDL_GetError());
-        return false;
-    }
-
-#ifdef SDL_HINT_IME_SHOW_UI
-    SDL_SetHint(SDL_HINT_IME_SHOW_UI, "1");
-#endif
-    printf("SDL initialized successfully.\n");
-    return true;
-}
-
-bool SetupExampleModel()
-{
-	texture.read_tga_file("Model/head.tga");
-	texture.flip_vertically();
-
-	normalMap.read_tga_file("Model/head_nm.tga");
-	normalMap.flip_vertically();
-
-	specularMap.read_tga_file("Model/head_spec.tga");
-	specularMap.flip_vertically();
-
-	return true;
-}
-
-// Function to setup the SDL window and renderer
-bool SetupAll(SDL_WindowFlags& window_flags, SDL_Window** ui_window, SDL_Renderer** windowRenderer, ImGuiIO& io, const char* title, int width, int height)
-{
-    window_flags = (SDL_WindowFlags)(SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI);
-
-    // Create SDL window
-    *ui_window = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 600, 600, window_flags);
-	model_window = SDL_CreateWindow("Model", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, window_flags);
-    if (*ui_window == nullptr)  // Fixed the condition to check the dereferenced pointer
-    {
-        printf("Error: SDL_CreateWindow() failed: %s\n", SDL_GetError());
-        return false;
-    }
-    printf("Window created successfully: %s\n", title);
-
-	if (model_window == nullptr)  // Fixed the condition to check the dereferenced pointer
-	{
-		printf("Error: SDL_CreateWindow() failed: %s\n", SDL_GetError());
-		SDL_DestroyWindow(*ui_window);  // Cleanup window if model window creation fails
-		return false;
-	}
-	printf("Model window created successfully.\n");
-
-    // Create SDL renderer
-    *windowRenderer = SDL_CreateRenderer(*ui_window, -1, SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_ACCELERATED);
-    if (*windowRenderer == nullptr)  // Fixed the condition to check the dereferenced pointer
-    {
-        printf("Error: SDL_CreateRenderer() failed: %s\n", SDL_GetError());
-        SDL_DestroyWindow(*ui_window);  // Cleanup window if renderer creation fails
-        return false;
-    }
-    printf("Renderer created successfully.\n");
-
-	renderer = SDL_CreateRenderer(model_window, -1, SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_ACCELERATED);
-	if (renderer == nullptr)  // Fixed the condition to check the dereferenced pointer
-	{
-		printf("Error: SDL_CreateRenderer() failed: %s\n", SDL_GetError());
-		SDL_DestroyWindow(model_window);  // Cleanup window if renderer creation fails
-		return false;
-	}
-
-    // Setup ImGui context
-    IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
-    io = ImGui::GetIO(); (void)io;
-    io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
-    io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
-    io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;         // Enable Docking
-
-    // Setup Dear ImGui style
-    ImGui::StyleColorsDark();
-
-    // Setup Platform/Renderer backends
-    if (!ImGui_ImplSDL2_InitForSDLRenderer(*ui_window, *windowRenderer))
-    {
-        printf("Error: ImGui_ImplSDL2_InitForSDLRenderer() failed\n");
-        return false;
-    }
-
-    if (!ImGui_ImplSDLRenderer2_Init(*windowRenderer))
-    {
-        printf("Error: ImGui_ImplSDLRenderer2_Init() failed\n");
-        return false;
-    }
-
-    printf("ImGui initialized successfully.\n");
-    return true;
-}
-
-// Function to render the model window
-void renderWindow(SDL_Window* ui_window, SDL_Renderer* windowRenderer, ImGuiIO& io, Model& model)
-{
-    bool show_demo_window = true;
-    bool done = false;
-
-    ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
-    shaderProgram shader;
-
-    while (!done)
-    {
-        SDL_Event event;
-        while (SDL_PollEvent(&event))
-        {
-            ImGui_ImplSDL2_ProcessEvent(&event);
-            if (event.type == SDL_QUIT)
-                done = true;
-            if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_CLOSE && event.window.windowID == SDL_GetWindowID(model_window))
-                done = true;
-        }
-
-        // Skip rendering if the window is minimized
-        if (SDL_GetWindowFlags(ui_window) & SDL_WINDOW_MINIMIZED)
-        {
-            SDL_Delay(10);
-            continue;
-        }
-
-        // Start a new ImGui frame
-        ImGui_ImplSDLRenderer2_NewFrame();
-        ImGui_ImplSDL2_NewFrame();
-        ImGui::NewFrame();
-
-        {
-			ImGui::Begin("Config:");
-            ImGui::Text("Camera Config: %.3f %.3f %.3f", Camera.x, Camera.y, Camera.z);
-
-            ImGui::SliderFloat("Camera X", &cameraX, -10.0f, 10.0f);
-            ImGui::SliderFloat("Camera Y", &cameraY, -10.0f, 10.0f);
-            ImGui::SliderFloat("Camera Z", &cameraZ, 0.5f, 10.0f);
-
-            ImGui::Text("Background Config:");
-            ImGui::ColorEdit3("clear color", (float*)&clear_color);
-
-            ImGui::Text("Light Config: %.3f %.3f %.3f", lightDirection.x, lightDirection.y, lightDirection.z);
-            ImGui::SliderFloat("light up", &upLight, -10.0f, 10.0f);
-            ImGui::SliderFloat("light down", &downLight, -10.0f, 10.0f);
-            ImGui::SliderFloat("light left", &leftLight, -10.0f, 10.0f);
-
-			ImGui::Text("Wireframe Config:");
-			ImGui::Checkbox("Wireframe", &drawWireframe);
-            
-            ImGui::End();
-        }
-
-		lightDirection = { upLight, downLight, leftLight };
-		Camera = { cameraX, cameraY, cameraZ };
-
-        ImGui::Render();
-
-        SDL_RenderSetScale(windowRenderer, io.DisplayFramebufferScale.x, io.DisplayFramebufferScale.y);
-        SDL_SetRenderDrawColor(windowRenderer, (clear_color.x * 255), (clear_color.y * 255), (clear_color.z * 255), (clear_color.w * 255));
-        SDL_RenderClear(windowRenderer);
-        ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData(), windowRenderer);
-        SDL_RenderPresent(windowRenderer);
-
-        SDL_SetRenderDrawColor(renderer, (clear_color.x * 255), (clear_color.y * 255), (clear_color.z * 255), (clear_color.w * 255));
-        SDL_RenderClear(renderer);
-        if (!drawWireframe)
-        {
-            renderModel(model, shader);
-            SDL_RenderPresent(renderer);
-        }
-        else
-        {
-			renderWireframe(model);
-			SDL_RenderPresent(renderer);
-        }
-        
-    }
-}
-
-// Cleanup function to free resources
-void Cleanup(SDL_Window* ui_window, SDL_Renderer* windowRenderer)
-{
-    ImGui_ImplSDLRenderer2_Shutdown();
-    ImGui_ImplSDL2_Shutdown();
-    ImGui::DestroyContext();
-
-    if (renderer)
-    {
-        SDL_DestroyRenderer(renderer);
-        printf("Renderer destroyed.\n");
-    }
-    if (model_window)
-    {
-        SDL_DestroyWindow(model_window);
-        printf("Window destroyed.\n");
-    }
-    if (windowRenderer)
-	{
-		SDL_DestroyRenderer(windowRenderer);
-		printf("Window renderer destroyed.\n");
-	}
-	if (ui_window)
-	{
-		SDL_DestroyWindow(ui_window);
-		printf("UI window destroyed.\n");
-	}
-
-    SDL_Quit();
-    printf("SDL cleaned up successfully.\n");
+#include "Setup.h"
+#include <cmath>
+
+SDL_Window* model_window;
+SDL_WindowFlags window_flags;
+
+// Function to setup SDL and initialize video
+bool SetupWindow()
+{
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_GAMECONTROLLER) != 0)
+    {
+        printf("Error: SDL_Init failed: %s\n", SDL_GetError());
+        return false;
+    }
+
+#ifdef SDL_HINT_IME_SHOW_UI
+    SDL_SetHint(SDL_HINT_IME_SHOW_UI, "1");
+#endif
+    printf("SDL initialized successfully.\n");
+    return true;
+}
+
+bool SetupExampleModel()
+{
+	// The three maps are packed into one material so the fragment shader needs a single fetch
+	return material.loadFromFiles("Model/head.tga", "Model/head_nm.tga", "Model/head_spec.tga");
+}
+
+// Function to setup the SDL window and renderer
+bool SetupAll(SDL_WindowFlags& window_flags, SDL_Window** ui_window, SDL_Renderer** windowRenderer, ImGuiIO& io, const char* title, int width, int height)
+{
+    window_flags = (SDL_WindowFlags)(SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI);
+
+    // Create SDL window
+    *ui_window = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 600, 600, window_flags);
+	model_window = SDL_CreateWindow("Model", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, window_flags);
+    if (*ui_window == nullptr)  // Fixed the condition to check the dereferenced pointer
+    {
+        printf("Error: SDL_CreateWindow() failed: %s\n", SDL_GetError());
+        return false;
+    }
+    printf("Window created successfully: %s\n", title);
+
+	if (model_window == nullptr)  // Fixed the condition to check the dereferenced pointer
+	{
+		printf("Error: SDL_CreateWindow() failed: %s\n", SDL_GetError());
+		SDL_DestroyWindow(*ui_window);  // Cleanup window if model window creation fails
+		return false;
+	}
+	printf("Model window created successfully.\n");
+
+    // Create SDL renderer. It presents without vsync: the render loop presents the UI, and waiting for the display there
+    // would pace rendering too; renderWindow throttles the UI with event timeouts instead.
+    *windowRenderer = SDL_CreateRenderer(*ui_window, -1, SDL_RENDERER_ACCELERATED);
+    if (*windowRenderer == nullptr)  // Fixed the condition to check the dereferenced pointer
+    {
+        printf("Error: SDL_CreateRenderer() failed: %s\n", SDL_GetError());
+        SDL_DestroyWindow(*ui_window);  // Cleanup window if renderer creation fails
+        return false;
+    }
+    printf("Renderer created successfully.\n");
+
+    // The model window's renderer is created by the Presenter on its own thread
+
+    // Setup ImGui context
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    io = ImGui::GetIO(); (void)io;
+    io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
+    io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
+    io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;         // Enable Docking
+
+    // Setup Dear ImGui style
+    ImGui::StyleColorsDark();
+
+    // Setup Platform/Renderer backends
+    if (!ImGui_ImplSDL2_InitForSDLRenderer(*ui_window, *windowRenderer))
+    {
+        printf("Error: ImGui_ImplSDL2_InitForSDLRenderer() failed\n");
+        return false;
+    }
+
+    if (!ImGui_ImplSDLRenderer2_Init(*windowRenderer))
+    {
+        printf("Error: ImGui_ImplSDLRenderer2_Init() failed\n");
+        return false;
+    }
+
+    printf("ImGui initialized successfully.\n");
+    return true;
+}
+
+// Function to lay out a crowd of instances in rows going away from the camera
+void layoutCrowd(Scene& scene, int mesh, int material, int count)
+{
+    const float spacing = 2.2f;
+    int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(count))));
+
+    scene.clearInstances();
+    for (int i = 0; i < count; ++i)
+    {
+        int column = i % columns;
+        int row = i / columns;
+
+        // Alternate left and right of the center column so instance 0 stays at the origin
+        int side = (column + 1) / 2;
+        float x = (column % 2 == 0 ? side : -side) * spacing;
+        scene.addInstance(mesh, material, translationMatrix({ x, 0.0f, -row * spacing }));
+    }
+}
+
+#if defined(RASTERIZER_PROFILE) || defined(RASTERIZER_COUNTERS)
+// Function to show the recorded frames: a rolling graph and the average of every stage, then the last frame's counters.
+// The stages are exclusive, so their graphs stack up to the frame rather than nest; without the timers compiled in
+// only the counters are shown.
+void drawProfilerWindow()
+{
+#ifdef RASTERIZER_PROFILE
+    static const char* stageNames[Profiler::StageCount] = {
+        "Frame", "Draw setup", "Vertex shading", "Binning", "Rasterization", "Fragment shading", "Clear", "Present"
+    };
+#endif
+    static const char* counterNames[Profiler::CounterCount] = {
+        "Triangles in", "Triangles culled", "Fragments shaded", "Depth rejects", "Heap allocations"
+    };
+
+    const Profiler& profiler = Profiler::instance();
+    ImGui::Begin("Profiler");
+    if (profiler.getFrameCount() > 0)
+    {
+#ifdef RASTERIZER_PROFILE
+        float history[Profiler::HistorySize];
+        for (int stage = 0; stage < Profiler::StageCount; ++stage)
+        {
+            profiler.copyStageHistory(static_cast<ProfileStage>(stage), history);
+            char overlay[64];
+            snprintf(overlay, sizeof(overlay), "avg %.2f ms", profiler.getAverageMs(static_cast<ProfileStage>(stage)));
+            ImGui::PlotLines(stageNames[stage], history, profiler.getFrameCount(), 0, overlay, 0.0f, FLT_MAX, ImVec2(0, 40));
+        }
+#endif
+
+        const ProfileFrame& frame = profiler.getFrame(0);
+        for (int counter = 0; counter < Profiler::CounterCount; ++counter)
+        {
+            ImGui::Text("%-18s %llu", counterNames[counter], static_cast<unsigned long long>(frame.counters[counter]));
+        }
+    }
+    ImGui::End();
+}
+#endif
+
+// Function to render the model window
+void renderWindow(SDL_Window* ui_window, SDL_Renderer* windowRenderer, ImGuiIO& io, Model& model, int frameLimit)
+{
+    bool show_demo_window = true;
+    bool done = false;
+    int loopIterations = 0;
+
+    ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
+    PhongShader shader;
+    bool specializedShader = true;
+    double renderMs = 0.0;
+
+    // Every instance shares the model's vertex data and the global material
+    Scene scene;
+    int headMesh = scene.addMesh(model);
+    int headMaterial = scene.addMaterial(material);
+    int crowdSize = 1;
+    layoutCrowd(scene, headMesh, headMaterial, crowdSize);
+
+    // Draws are recorded every frame and sorted so nearby heads fill the depth buffer first
+    RenderCommandBuffer commands;
+    bool sortDraws = true;
+
+    // The model window is presented from its own thread, so neither the rasterizer nor this loop waits for its vsync
+    Presenter presenter(model_window);
+    bool uncapped = false;
+    if (!presenter.start(!uncapped))
+    {
+        return;
+    }
+
+    // The model is rendered into a software target that matches the model window
+    int targetWidth = 0;
+    int targetHeight = 0;
+    presenter.getOutputSize(targetWidth, targetHeight);
+    RenderTarget target(targetWidth, targetHeight);
+
+    // Pipelined mode renders on the pipeline's threads and its present stage hands finished frames to the presenter
+    bool pipelinedFrames = true;
+    FramePipeline<PhongShader> pipeline(targetWidth, targetHeight, 3, [&presenter](const RenderTarget& frame, uint64_t)
+    {
+        presenter.publish(frame);
+    });
+
+    // Loading, vertex, binning, raster and re-shade work is split over the shared job system's threads
+    int maxJobThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    int jobThreads = JobSystem::instance().getThreadCount();
+    bool pinJobThreads = JobSystem::instance().getPinThreads();
+
+    // Measure the fast shading kernels once so the Config window can show their error
+    std::vector<KernelError> accuracyReport = measureShadingMathAccuracy();
+    printShadingMathReport(accuracyReport);
+
+    // A frame is rendered only when the settings or the scene changed since the last one; otherwise the presenter
+    // keeps showing the previous image
+    uint64_t settingsRevision = 1;
+    uint64_t renderedSettingsRevision = 0;
+    uint64_t renderedSceneRevision = 0;
+    uint64_t lightRevision = 1;
+    uint64_t renderedLightRevision = 0;
+    int idleFrames = 0;
+
+    // Without vsync on the UI renderer, iterations that render nothing wait for input up to one display refresh
+    SDL_DisplayMode displayMode;
+    int refreshRate = 60;
+    if (SDL_GetCurrentDisplayMode(std::max(0, SDL_GetWindowDisplayIndex(ui_window)), &displayMode) == 0 && displayMode.refresh_rate > 0)
+    {
+        refreshRate = displayMode.refresh_rate;
+    }
+    const int uiFrameMs = std::max(1, 1000 / refreshRate);
+
+    // When only the light changed, the visible surfaces of the last immediate frame are shaded again instead of
+    // rasterizing the scene. visibilityValid is true while the target's visibility attachment matches the scene.
+    bool deferredLighting = true;
+    bool visibilityValid = false;
+    target.setVisibilityEnabled(deferredLighting);
+
+    while (!done)
+    {
+        // Everything recorded since the previous iteration, on any thread, belongs to the frame that ends here
+        PROFILE_END_FRAME();
+
+        // A frame limit ends the session without input, e.g. for smoke tests under the SDL dummy video driver
+        if (frameLimit > 0 && loopIterations++ >= frameLimit)
+        {
+            break;
+        }
+
+        // Iterations that render a frame never wait. Otherwise the UI is paced to the display until ImGui has settled
+        // after the last input, then sleeps until the next event instead of polling.
+        if (idleFrames > 2)
+        {
+            SDL_WaitEventTimeout(nullptr, 500);
+        }
+        else if (idleFrames > 0)
+        {
+            SDL_WaitEventTimeout(nullptr, uiFrameMs);
+        }
+
+        SDL_Event event;
+        while (SDL_PollEvent(&event))
+        {
+            ImGui_ImplSDL2_ProcessEvent(&event);
+            if (event.type == SDL_QUIT)
+                done = true;
+            if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_CLOSE && event.window.windowID == SDL_GetWindowID(model_window))
+                done = true;
+        }
+
+        // The presenter tracks the drawable size of the model window; follow it when the window was resized
+        int outputWidth = 0;
+        int outputHeight = 0;
+        presenter.getOutputSize(outputWidth, outputHeight);
+        if ((outputWidth != targetWidth || outputHeight != targetHeight) && outputWidth > 0 && outputHeight > 0)
+        {
+            targetWidth = outputWidth;
+            targetHeight = outputHeight;
+            target.resize(targetWidth, targetHeight);
+            pipeline.resize(targetWidth, targetHeight);
+            ++settingsRevision;
+        }
+
+        // Skip rendering if the window is minimized
+        if (SDL_GetWindowFlags(ui_window) & SDL_WINDOW_MINIMIZED)
+        {
+            SDL_Delay(10);
+            continue;
+        }
+
+        // Start a new ImGui frame
+        ImGui_ImplSDLRenderer2_NewFrame();
+        ImGui_ImplSDL2_NewFrame();
+        ImGui::NewFrame();
+
+        // Set by any widget whose change affects the rendered image; light changes are tracked on their own because
+        // they only need the shading pass
+        bool settingsChanged = false;
+        bool lightChanged = false;
+        {
+			ImGui::Begin("Config:");
+            ImGui::Text("Camera Config: %.3f %.3f %.3f", Camera.x, Camera.y, Camera.z);
+
+            settingsChanged |= ImGui::SliderFloat("Camera X", &cameraX, -10.0f, 10.0f);
+            settingsChanged |= ImGui::SliderFloat("Camera Y", &cameraY, -10.0f, 10.0f);
+            settingsChanged |= ImGui::SliderFloat("Camera Z", &cameraZ, 0.5f, 10.0f);
+
+            ImGui::Text("Background Config:");
+            settingsChanged |= ImGui::ColorEdit3("clear color", (float*)&clear_color);
+
+            ImGui::Text("Light Config: %.3f %.3f %.3f", lightDirection.x, lightDirection.y, lightDirection.z);
+            lightChanged |= ImGui::SliderFloat("light up", &upLight, -10.0f, 10.0f);
+            lightChanged |= ImGui::SliderFloat("light down", &downLight, -10.0f, 10.0f);
+            lightChanged |= ImGui::SliderFloat("light left", &leftLight, -10.0f, 10.0f);
+
+            ImGui::Text("Scene Config:");
+            if (ImGui::SliderInt("Crowd size", &crowdSize, 1, 400))
+            {
+                // Frames in flight still read the scene
+                pipeline.flush();
+                layoutCrowd(scene, headMesh, headMaterial, crowdSize);
+            }
+            if (ImGui::Checkbox("Pipelined frames", &pipelinedFrames))
+            {
+                if (!pipelinedFrames)
+                {
+                    pipeline.flush();
+                }
+                settingsChanged = true;
+            }
+            bool jobThreadsChanged = ImGui::SliderInt("Job threads", &jobThreads, 1, maxJobThreads);
+            jobThreadsChanged |= ImGui::Checkbox("Pin job threads", &pinJobThreads);
+            if (jobThreadsChanged)
+            {
+                // Output is identical for every count, so only the timing changes. No job may run while the
+                // workers are replaced, so the pipeline finishes its frames first.
+                pipeline.flush();
+                JobSystem::instance().configure(jobThreads, pinJobThreads);
+                settingsChanged = true;
+            }
+            settingsChanged |= ImGui::Checkbox("Sort draws", &sortDraws);
+            if (ImGui::Checkbox("Re-shade light changes", &deferredLighting))
+            {
+                target.setVisibilityEnabled(deferredLighting);
+                visibilityValid = false;
+            }
+            ImGui::Text("Draws: %d, state changes: %d", static_cast<int>(commands.size()), commands.getStateChanges());
+
+			ImGui::Text("Wireframe Config:");
+			settingsChanged |= ImGui::Checkbox("Wireframe", &drawWireframe);
+
+            ImGui::Text("Shader Config:");
+            int quality = static_cast<int>(shader.quality);
+            if (ImGui::Combo("Shader quality", &quality, "Reference\0Fast math\0"))
+            {
+                shader.quality = static_cast<ShaderQuality>(quality);
+                settingsChanged = true;
+            }
+            settingsChanged |= ImGui::Checkbox("Specialized raster loop", &specializedShader);
+
+            ImGui::Text("Depth Config:");
+            DepthBuffer& depthBuffer = target.getDepthBuffer();
+            int depthFormat = static_cast<int>(depthBuffer.getFormat());
+            bool reversedZ = depthBuffer.isReversedZ();
+            bool depthChanged = ImGui::Combo("Depth format", &depthFormat, "Float32\0Unorm24\0Unorm16\0");
+            depthChanged = ImGui::Checkbox("Reversed-Z", &reversedZ) || depthChanged;
+            if (depthChanged)
+            {
+                depthBuffer.configure(static_cast<DepthFormat>(depthFormat), reversedZ);
+                pipeline.configureDepth(static_cast<DepthFormat>(depthFormat), reversedZ);
+                settingsChanged = true;
+            }
+
+            ImGui::Text("Presentation Config:");
+            if (ImGui::Checkbox("Uncapped (no vsync)", &uncapped))
+            {
+                presenter.setVSync(!uncapped);
+            }
+            ImGui::Text("Render: %.1f FPS, display: %.1f FPS", presenter.getRenderFps(), presenter.getDisplayFps());
+
+#ifdef RASTERIZER_TRACE
+            ImGui::Text("Trace Config:");
+            TraceRecorder& recorder = TraceRecorder::instance();
+            bool tracing = recorder.isEnabled();
+            if (ImGui::Checkbox("Record trace", &tracing))
+            {
+                recorder.setEnabled(tracing);
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Write trace.json"))
+            {
+                recorder.writeChromeTrace("trace.json");
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Clear trace"))
+            {
+                recorder.clear();
+            }
+            ImGui::Text("Trace events: %d, dropped: %d", static_cast<int>(recorder.getEventCount()), static_cast<int>(recorder.getDroppedCount()));
+#endif
+
+            if (pipelinedFrames && !drawWireframe)
+            {
+                ImGui::Text("Stage times: geometry %.2f, binning %.2f, raster %.2f ms", pipeline.getStageMs(PipelineStage::Geometry),
+                    pipeline.getStageMs(PipelineStage::Binning), pipeline.getStageMs(PipelineStage::Raster));
+            }
+            ImGui::Text("Render time: %.2f ms (immediate or re-shaded frames)", renderMs);
+            if (ImGui::TreeNode("Fast math accuracy"))
+            {
+                for (const KernelError& error : accuracyReport)
+                {
+                    ImGui::Text("%-16s max abs %.2e  max rel %.2e", error.name, error.maxAbsError, error.maxRelError);
+                }
+                ImGui::TreePop();
+            }
+            
+            ImGui::End();
+        }
+
+#if defined(RASTERIZER_PROFILE) || defined(RASTERIZER_COUNTERS)
+        drawProfilerWindow();
+#endif
+
+        if (settingsChanged)
+        {
+            ++settingsRevision;
+        }
+        if (lightChanged)
+        {
+            ++lightRevision;
+        }
+
+		lightDirection = { upLight, downLight, leftLight };
+		Camera = { cameraX, cameraY, cameraZ };
+		updateWorld();
+
+        ImGui::Render();
+
+        SDL_RenderSetScale(windowRenderer, io.DisplayFramebufferScale.x, io.DisplayFramebufferScale.y);
+        SDL_SetRenderDrawColor(windowRenderer, (clear_color.x * 255), (clear_color.y * 255), (clear_color.z * 255), (clear_color.w * 255));
+        SDL_RenderClear(windowRenderer);
+        ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData(), windowRenderer);
+        {
+            PROFILE_SCOPE(ProfileStage::Present);
+            SDL_RenderPresent(windowRenderer);
+        }
+
+        if (done)
+        {
+            break;
+        }
+
+        // Uncapped mode renders every iteration so it can be used to measure the renderer
+        bool geometryDirty = settingsRevision != renderedSettingsRevision || scene.getRevision() != renderedSceneRevision;
+        bool lightDirty = lightRevision != renderedLightRevision;
+        if (!uncapped && !geometryDirty && !lightDirty)
+        {
+            ++idleFrames;
+            continue;
+        }
+        idleFrames = 0;
+        renderedSettingsRevision = settingsRevision;
+        renderedSceneRevision = scene.getRevision();
+        renderedLightRevision = lightRevision;
+
+        bool lightOnly = lightDirty && !geometryDirty && deferredLighting && !drawWireframe;
+        if (lightOnly && visibilityValid)
+        {
+            // Camera and geometry are unchanged: shade the stored visible surfaces with the new light
+            TRACE_SCOPE("Re-shade frame");
+            Uint64 reshadeStart = SDL_GetPerformanceCounter();
+            reshadeVisibility(commands, currentView(), shader, target);
+            renderMs = (SDL_GetPerformanceCounter() - reshadeStart) * 1000.0 / SDL_GetPerformanceFrequency();
+            presenter.publish(target);
+            continue;
+        }
+
+        Color background = { static_cast<uint8_t>(clear_color.x * 255), static_cast<uint8_t>(clear_color.y * 255), static_cast<uint8_t>(clear_color.z * 255), 255 };
+        if (pipelinedFrames && !drawWireframe && !lightOnly)
+        {
+            // Waits only when every frame in flight is still busy
+            pipeline.submit(scene, currentView(), shader, background);
+            visibilityValid = false;
+            continue;
+        }
+
+        // A light change without a usable visibility attachment renders one immediate frame that fills it; frames in
+        // flight must be presented before it
+        if (pipelinedFrames)
+        {
+            pipeline.flush();
+        }
+
+        target.clear(background);
+        if (!drawWireframe)
+        {
+            // The specialized loop is compiled for PhongShader; the other path goes through the virtual interface
+            TRACE_SCOPE("Render frame");
+            Uint64 renderStart = SDL_GetPerformanceCounter();
+            commands.clear();
+            if (specializedShader)
+            {
+                commands.recordScene(scene, shader);
+            }
+            else
+            {
+                commands.recordScene(scene, static_cast<shaderProgram&>(shader));
+            }
+            if (sortDraws)
+            {
+                commands.sort(viewMatrix);
+            }
+            commands.execute(currentView(), target);
+            renderMs = (SDL_GetPerformanceCounter() - renderStart) * 1000.0 / SDL_GetPerformanceFrequency();
+            visibilityValid = deferredLighting;
+        }
+        else
+        {
+			renderWireframe(model, target);
+            visibilityValid = false;
+        }
+
+        // Fill the tiles nothing was drawn to and hand the image to the presenter
+        target.resolve();
+        presenter.publish(target);
+    }
+
+#ifdef RASTERIZER_TRACE
+    // A trace still being recorded at exit is written out, so a run started with --trace needs no button press
+    if (TraceRecorder::instance().isEnabled())
+    {
+        TraceRecorder::instance().writeChromeTrace("trace.json");
+    }
+#endif
+}
+
+// Cleanup function to free resources
+void Cleanup(SDL_Window* ui_window, SDL_Renderer* windowRenderer)
+{
+    ImGui_ImplSDLRenderer2_Shutdown();
+    ImGui_ImplSDL2_Shutdown();
+    ImGui::DestroyContext();
+
+    if (model_window)
+    {
+        SDL_DestroyWindow(model_window);
+        printf("Window destroyed.\n");
+    }
+    if (windowRenderer)
+	{
+		SDL_DestroyRenderer(windowRenderer);
+		printf("Window renderer destroyed.\n");
+	}
+	if (ui_window)
+	{
+		SDL_DestroyWindow(ui_window);
+		printf("UI window destroyed.\n");
+	}
+
+    SDL_Quit();
+    printf("SDL cleaned up successfully.\n");
 }
\ No newline at end of file
@@ -1,26 +1,47 @@
-#pragma once
-
-#include "imgui.h"
-#include "imgui_impl_sdl2.h"
-#include "imgui_impl_sdlrenderer2.h"
-#include "Model.h"
-#include "Renderer.h"
-#include "Wireframe.h"
-#include "World.h"
-#include <SDL.h>
-#include <stdio.h>
-
-// Setup SDL and create window
-bool SetupWindow();
-
-// Draw an exmaple model
-bool SetupExampleModel();
-
-// Setup All SDL and ImGui
-bool SetupAll(SDL_WindowFlags& window_flags, SDL_Window** ui_window, SDL_Renderer** windowRenderer, ImGuiIO& io,const char* title, int width, int height);
-
-// Render Window
-void renderWindow(SDL_Window* ui_window, SDL_Renderer* windowRenderer, ImGuiIO& io, Model& model);
-
-// Cleanup
+#pragma once
+
+#include "imgui.h"
+#include "imgui_impl_sdl2.h"
+#include "imgui_impl_sdlrenderer2.h"
+#include "DeferredShading.h"
+#include "FramePipeline.h"
+#include "JobSystem.h"
+#include "Model.h"
+#include "Presenter.h"
+#include "Profiler.h"
+#include "RenderCommandBuffer.h"
+#include "RenderTarget.h"
+#include "Renderer.h"
+#include "Scene.h"
+#include "TraceRecorder.h"
+#include "Wireframe.h"
+#include "World.h"
+#include <SDL.h>
+#include <stdio.h>
+
+// Window the model is presented in
+extern SDL_Window* model_window;
+extern SDL_WindowFlags window_flags;
+
+// Setup SDL and create window
+bool SetupWindow();
+
+// Draw an exmaple model
+bool SetupExampleModel();
+
+// Setup All SDL and ImGui
+bool SetupAll(SDL_WindowFlags& window_flags, SDL_Window** ui_window, SDL_Renderer** windowRenderer, ImGuiIO& io,const char* title, int width, int height);
+
+// Replace the instances of a scene with a grid of copies of one mesh, the first one at the origin
+void layoutCrowd(Scene& scene, int mesh, int material, int count);
+
+#if defined(RASTERIZER_PROFILE) || defined(RASTERIZER_COUNTERS)
+// Profiler window: per-stage graphs and counters
+void drawProfilerWindow();
+#endif
+
+// Render Window; a positive frameLimit closes it after that many loop iterations
+void renderWindow(SDL_Window* ui_window, SDL_Renderer* windowRenderer, ImGuiIO& io, Model& model, int frameLimit = 0);
+
+// Cleanup
 void Cleanup(SDL_Window* ui_window, SDL_Renderer* windowRenderer);
\ No newline at end of file
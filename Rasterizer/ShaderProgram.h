@@ -1,33 +1,317 @@
-#pragma once
-
-#include "Matrix.h"
-#include "Structs.h"
-#include "World.h"
-#include <algorithm>
-#include <iostream>
-#include <string>
-#include <vector>
-
-class shaderProgram
-{
-public:
-	Matrix uniform_M;
-
-	Matrix uniform_MIT;
-
-	Matrix uniform_Transform;
-
-	TexCoord uvCoord[3];
-
-	shaderProgram();
-
-	// Transform the vertex from model space to screen space
-	virtual Vertex vertexShader(Vertex& vertex, Vertex& vertexNormal, TexCoord& uv, int ith);
-
-	// Fragment shader
-	virtual bool fragmentShader(Vertex &bary, SDL_Color& color);
-
-	virtual Vertex transformNormal(Vertex& normal, Matrix& transform);
-
-	virtual Vertex transformDirection(Vertex& direction, Matrix& transform);
-};
+#pragma once
+
+#include "Matrix.h"
+#include "ShadingMath.h"
+#include "Structs.h"
+#include "World.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// 2x2 block of fragments shaded together. Lanes are ordered (x, y), (x + 1, y), (x, y + 1), (x + 1, y + 1),
+// so differences between lanes give the screen-space derivatives of anything interpolated across the quad.
+struct FragmentQuad {
+	alignas(16) float baryX[4]; // Barycentric weight of vertex 0 per lane
+	alignas(16) float baryY[4]; // Barycentric weight of vertex 1 per lane
+	alignas(16) float baryZ[4]; // Barycentric weight of vertex 2 per lane
+	int mask;                   // Bit i is set when lane i is covered and passed the depth test
+};
+
+class shaderProgram
+{
+public:
+	Matrix uniform_M;
+
+	Matrix uniform_MIT;
+
+	Matrix uniform_Transform;
+
+	TexCoord uvCoord[3];
+
+	// Light direction in the same space as the transformed normals, normalized; set by setTransforms
+	Vertex uniform_LightDir;
+
+	// Material sampled by the fragment shader; the global material unless a draw selects another
+	const Material* uniform_Material;
+
+	// Reference or fast approximate math in the fragment shader
+	ShaderQuality quality;
+
+	shaderProgram();
+
+	virtual ~shaderProgram() = default;
+
+	// Set the transform and light uniforms for drawing one instance into a viewport
+	void setTransforms(const Matrix& viewProjection, const Matrix& modelMatrix, const Matrix& viewportTransform, const Vertex& light);
+
+	// Transform a vertex position from model space to screen space
+	virtual Vertex transformVertex(const Vertex& vertex);
+
+	// Transform the vertex from model space to screen space
+	virtual Vertex vertexShader(const Vertex& vertex, const Vertex& vertexNormal, const TexCoord& uv, int ith);
+
+	// Fragment shader
+	virtual bool fragmentShader(const Vertex& bary, Color& color);
+
+	// Fragment shader for a 2x2 quad; returns the mask of lanes that were not discarded
+	virtual int fragmentShaderQuad(const FragmentQuad& quad, Color colors[4]);
+
+	virtual Vertex transformNormal(const Vertex& normal, const Matrix& transform);
+
+	virtual Vertex transformDirection(const Vertex& direction, const Matrix& transform);
+};
+
+// The default Phong shader as a final type. Passing it to the renderModel template resolves every shader call
+// at compile time, so the stages below inline into the raster loop; pass a shaderProgram& to select shaders at run time.
+class PhongShader final : public shaderProgram
+{
+};
+
+// True for shader types the renderers may copy per draw, view or job. A copy of the shaderProgram interface, or of any
+// shader still open to derivation, would slice off the shader it stands for, so those are only passed by reference.
+template <typename Shader>
+constexpr bool isCopyableShader = std::is_final<Shader>::value || !std::is_polymorphic<Shader>::value;
+
+// The shader stages are defined in the header so they can be inlined into specialized raster loops
+
+// Function to derive the per-instance uniforms; the light is transformed once here instead of once per fragment
+inline void shaderProgram::setTransforms(const Matrix& viewProjection, const Matrix& modelMatrix, const Matrix& viewportTransform, const Vertex& light)
+{
+	uniform_M = viewProjection * modelMatrix;
+	uniform_MIT = uniform_M.invertTranspose();
+	uniform_Transform = viewportTransform * uniform_M;
+
+	// The light lives in world space, so it skips the model matrix
+	uniform_LightDir = transformDirection(light, viewProjection);
+	normalizeVertex(uniform_LightDir, quality);
+}
+
+// Vertex shader function: Computes the screen coordinates and light intensity for a vertex
+inline Vertex shaderProgram::vertexShader(const Vertex& vertex, const Vertex& vertexNormal, const TexCoord& uv, int ith)
+{
+	// Store the UV coordinates for the current vertex
+	uvCoord[ith] = uv;
+
+	return transformVertex(vertex);
+}
+
+// Function to project a model-space position to screen coordinates
+inline Vertex shaderProgram::transformVertex(const Vertex& vertex)
+{
+	// Transform the vertex into screen coordinates using the combined transformation matrix
+	Matrix mat1 = uniform_Transform * (vertexToMatrix(vertex));
+
+	// Convert the homogeneous coordinates to screen coordinates (the viewport already points Y down).
+	// Depth is 1/w: it orders points like z/w but stays in (0, 1] in front of the camera at any camera distance,
+	// and it is affine in screen space so the rasterizer can interpolate it directly.
+	Vertex screenCoord = {
+		mat1[0][0] / mat1[3][0],      // X coordinate
+		mat1[1][0] / mat1[3][0],      // Y coordinate
+		1.0f / mat1[3][0]             // Depth, larger is nearer
+	};
+
+	return screenCoord; // Return the computed screen coordinates
+}
+
+// Optimized Fragment shader function
+inline bool shaderProgram::fragmentShader(const Vertex& bary, Color& color)
+{
+    // Interpolate UV coordinates based on barycentric coordinates
+    TexCoord uv = interpolateTexCoordinates(uvCoord, bary);
+
+    // Fetch albedo, specular exponent and normal with a single lookup
+    MaterialTexel texel = uniform_Material->sample(uv.u, uv.v);
+
+    const float scaleFactor = 0.007843f; // 1/255
+    Texel colorNormal = texel.normal;
+
+    // Precompute scaled values for color components
+    float red = static_cast<float>(colorNormal.r) * scaleFactor;
+    float green = static_cast<float>(colorNormal.g) * scaleFactor;
+    float blue = static_cast<float>(colorNormal.b) * scaleFactor;
+
+    // Directly compute the normal without repeating calculations
+    Vertex normal = {
+        red - 1.0f,   // X component (normalized)
+        green - 1.0f, // Y component (normalized)
+        blue - 1.0f   // Z component (normalized)
+    };
+
+    // Transform and normalize the normal vector in world space
+    normal = transformNormal(normal, uniform_MIT);
+    normalizeVertex(normal, quality);
+
+    const Vertex& lightDir = uniform_LightDir;
+
+    // Compute the dot product between the normal and the light direction
+    float dotNL = std::max(0.0f, dotProduct(normal, lightDir)); // Merged dotNL and diff
+
+    // Reflection vector calculation
+    Vertex reflectedDir = {
+        normal.x * 2.0f * dotNL - lightDir.x,
+        normal.y * 2.0f * dotNL - lightDir.y,
+        normal.z * 2.0f * dotNL - lightDir.z
+    };
+    normalizeVertex(reflectedDir, quality);
+
+    // Retrieve specular intensity from the material
+    float specularIntensity = texel.albedoSpecular.a;
+    float spec = shadingPow(std::max(reflectedDir.z, 0.0f), specularIntensity, quality);
+
+    // Retrieve texture color
+    Texel colorTex = texel.albedoSpecular;
+
+    // Compute final color using texture color, diffuse, and specular intensity
+    float intensity = dotNL + 0.6f * spec; // Merged diff and spec factor
+    color.r = std::min(255.0f, 5.0f + colorTex.r * intensity);
+    color.g = std::min(255.0f, 5.0f + colorTex.g * intensity);
+    color.b = std::min(255.0f, 5.0f + colorTex.b * intensity);
+
+    return false; // No pixel discard
+}
+
+// Fragment shader for a 2x2 quad: the same Phong model as fragmentShader, four lanes at a time
+inline int shaderProgram::fragmentShaderQuad(const FragmentQuad& quad, Color colors[4])
+{
+#ifdef RASTERIZER_SSE
+    __m128 baryX = _mm_load_ps(quad.baryX);
+    __m128 baryY = _mm_load_ps(quad.baryY);
+    __m128 baryZ = _mm_load_ps(quad.baryZ);
+
+    // Interpolate UV coordinates for all four lanes
+    __m128 u = _mm_add_ps(_mm_add_ps(_mm_mul_ps(baryX, _mm_set1_ps(uvCoord[0].u)), _mm_mul_ps(baryY, _mm_set1_ps(uvCoord[1].u))),
+        _mm_mul_ps(baryZ, _mm_set1_ps(uvCoord[2].u)));
+    __m128 v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(baryX, _mm_set1_ps(uvCoord[0].v)), _mm_mul_ps(baryY, _mm_set1_ps(uvCoord[1].v))),
+        _mm_mul_ps(baryZ, _mm_set1_ps(uvCoord[2].v)));
+
+    // Gather albedo, specular exponent and normal for every lane
+    __m128i albedoSpecular;
+    __m128i packedNormal;
+    uniform_Material->sample4(u, v, albedoSpecular, packedNormal);
+
+    const __m128i byteMask = _mm_set1_epi32(0xFF);
+    const __m128 scaleFactor = _mm_set1_ps(0.007843f); // 2/255
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 nx = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(packedNormal, byteMask)), scaleFactor), one);
+    __m128 ny = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(packedNormal, 8), byteMask)), scaleFactor), one);
+    __m128 nz = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(packedNormal, 16), byteMask)), scaleFactor), one);
+
+    // Transform the normals to world space
+    __m128 normalX = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(uniform_MIT[0][0]), nx), _mm_mul_ps(_mm_set1_ps(uniform_MIT[0][1]), ny)),
+        _mm_mul_ps(_mm_set1_ps(uniform_MIT[0][2]), nz));
+    __m128 normalY = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(uniform_MIT[1][0]), nx), _mm_mul_ps(_mm_set1_ps(uniform_MIT[1][1]), ny)),
+        _mm_mul_ps(_mm_set1_ps(uniform_MIT[1][2]), nz));
+    __m128 normalZ = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(uniform_MIT[2][0]), nx), _mm_mul_ps(_mm_set1_ps(uniform_MIT[2][1]), ny)),
+        _mm_mul_ps(_mm_set1_ps(uniform_MIT[2][2]), nz));
+
+    // The light direction is uniform and was transformed once per draw
+    __m128 lightX = _mm_set1_ps(uniform_LightDir.x);
+    __m128 lightY = _mm_set1_ps(uniform_LightDir.y);
+    __m128 lightZ = _mm_set1_ps(uniform_LightDir.z);
+
+    if (quality == ShaderQuality::Fast)
+    {
+        fastNormalize4(normalX, normalY, normalZ);
+    }
+    else
+    {
+        __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(normalX, normalX), _mm_mul_ps(normalY, normalY)), _mm_mul_ps(normalZ, normalZ)));
+        length = _mm_max_ps(length, _mm_set1_ps(1e-30f));
+        normalX = _mm_div_ps(normalX, length);
+        normalY = _mm_div_ps(normalY, length);
+        normalZ = _mm_div_ps(normalZ, length);
+    }
+
+    // Diffuse term
+    __m128 dotNL = _mm_add_ps(_mm_add_ps(_mm_mul_ps(normalX, lightX), _mm_mul_ps(normalY, lightY)), _mm_mul_ps(normalZ, lightZ));
+    dotNL = _mm_max_ps(dotNL, _mm_setzero_ps());
+
+    // Reflection vector; only its z component feeds the specular term
+    __m128 twoDotNL = _mm_add_ps(dotNL, dotNL);
+    __m128 reflectedX = _mm_sub_ps(_mm_mul_ps(normalX, twoDotNL), lightX);
+    __m128 reflectedY = _mm_sub_ps(_mm_mul_ps(normalY, twoDotNL), lightY);
+    __m128 reflectedZ = _mm_sub_ps(_mm_mul_ps(normalZ, twoDotNL), lightZ);
+    __m128 reflectedLength = _mm_add_ps(_mm_add_ps(_mm_mul_ps(reflectedX, reflectedX), _mm_mul_ps(reflectedY, reflectedY)),
+        _mm_mul_ps(reflectedZ, reflectedZ));
+    reflectedLength = _mm_max_ps(reflectedLength, _mm_set1_ps(1e-30f));
+
+    __m128 specularIntensity = _mm_cvtepi32_ps(_mm_srli_epi32(albedoSpecular, 24));
+    __m128 spec;
+    if (quality == ShaderQuality::Fast)
+    {
+        __m128 reflectedDirZ = _mm_mul_ps(reflectedZ, fastRsqrt4(reflectedLength));
+        spec = fastPow4(_mm_max_ps(reflectedDirZ, _mm_setzero_ps()), specularIntensity);
+    }
+    else
+    {
+        __m128 reflectedDirZ = _mm_div_ps(reflectedZ, _mm_sqrt_ps(reflectedLength));
+        alignas(16) float base[4];
+        alignas(16) float exponent[4];
+        _mm_store_ps(base, _mm_max_ps(reflectedDirZ, _mm_setzero_ps()));
+        _mm_store_ps(exponent, specularIntensity);
+        spec = _mm_setr_ps(std::pow(base[0], exponent[0]), std::pow(base[1], exponent[1]),
+            std::pow(base[2], exponent[2]), std::pow(base[3], exponent[3]));
+    }
+
+    // Final color: texture color scaled by diffuse + specular, clamped to 255
+    __m128 intensity = _mm_add_ps(dotNL, _mm_mul_ps(_mm_set1_ps(0.6f), spec));
+    __m128 ambient = _mm_set1_ps(5.0f);
+    __m128 maxColor = _mm_set1_ps(255.0f);
+    __m128 red = _mm_cvtepi32_ps(_mm_and_si128(albedoSpecular, byteMask));
+    __m128 green = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(albedoSpecular, 8), byteMask));
+    __m128 blue = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(albedoSpecular, 16), byteMask));
+
+    alignas(16) int r[4];
+    alignas(16) int g[4];
+    alignas(16) int b[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(r), _mm_cvttps_epi32(_mm_min_ps(maxColor, _mm_add_ps(ambient, _mm_mul_ps(red, intensity)))));
+    _mm_store_si128(reinterpret_cast<__m128i*>(g), _mm_cvttps_epi32(_mm_min_ps(maxColor, _mm_add_ps(ambient, _mm_mul_ps(green, intensity)))));
+    _mm_store_si128(reinterpret_cast<__m128i*>(b), _mm_cvttps_epi32(_mm_min_ps(maxColor, _mm_add_ps(ambient, _mm_mul_ps(blue, intensity)))));
+
+    for (int lane = 0; lane < 4; ++lane)
+    {
+        colors[lane].r = static_cast<uint8_t>(r[lane]);
+        colors[lane].g = static_cast<uint8_t>(g[lane]);
+        colors[lane].b = static_cast<uint8_t>(b[lane]);
+    }
+
+    return quad.mask; // No pixel discard
+#else
+    // Without SSE shade the covered lanes one at a time
+    int written = 0;
+    for (int lane = 0; lane < 4; ++lane)
+    {
+        if (quad.mask & (1 << lane))
+        {
+            Vertex bary = { quad.baryX[lane], quad.baryY[lane], quad.baryZ[lane] };
+            if (!fragmentShader(bary, colors[lane]))
+            {
+                written |= 1 << lane;
+            }
+        }
+    }
+    return written;
+#endif
+}
+
+inline Vertex shaderProgram::transformNormal(const Vertex& normal, const Matrix& transform)
+{
+	return {
+		transform[0][0] * normal.x + transform[0][1] * normal.y + transform[0][2] * normal.z,
+		transform[1][0] * normal.x + transform[1][1] * normal.y + transform[1][2] * normal.z,
+		transform[2][0] * normal.x + transform[2][1] * normal.y + transform[2][2] * normal.z
+	};
+}
+
+inline Vertex shaderProgram::transformDirection(const Vertex& direction, const Matrix& transform)
+{
+	// Direct matrix multiplication without creating an unnecessary copy
+	return {
+		transform[0][0] * direction.x + transform[0][1] * direction.y + transform[0][2] * direction.z,
+		transform[1][0] * direction.x + transform[1][1] * direction.y + transform[1][2] * direction.z,
+		transform[2][0] * direction.x + transform[2][1] * direction.y + transform[2][2] * direction.z
+	};
+}
+
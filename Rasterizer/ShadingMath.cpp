@@ -0,0 +1,123 @@
+#include "ShadingMath.h"
+#include <cstdio>
+
+namespace {
+
+// Small deterministic generator so reports are reproducible between runs
+struct SampleGenerator {
+    uint32_t state = 0x12345678u;
+
+    // Uniform float in [lo, hi)
+    float next(float lo, float hi) {
+        state = state * 1664525u + 1013904223u;
+        return lo + (hi - lo) * static_cast<float>(state >> 8) * (1.0f / 16777216.0f);
+    }
+};
+
+// Accumulates error statistics for one kernel
+struct ErrorAccumulator {
+    KernelError error;
+    double sumAbsError = 0.0;
+
+    explicit ErrorAccumulator(const char* name) : error{ name, 0.0, 0.0, 0.0, 0 } {
+    }
+
+    void add(double reference, double approximation) {
+        double absError = std::fabs(approximation - reference);
+        error.maxAbsError = std::max(error.maxAbsError, absError);
+        if (std::fabs(reference) >= 1e-3) {
+            error.maxRelError = std::max(error.maxRelError, absError / std::fabs(reference));
+        }
+        sumAbsError += absError;
+        error.samples++;
+    }
+
+    KernelError result() const {
+        KernelError out = error;
+        out.meanAbsError = error.samples > 0 ? sumAbsError / error.samples : 0.0;
+        return out;
+    }
+};
+
+} // namespace
+
+// Function to measure the approximate kernels against the reference math over the shader's input ranges
+std::vector<KernelError> measureShadingMathAccuracy(int samples) {
+    SampleGenerator gen;
+    ErrorAccumulator rsqrt("rsqrt");
+    ErrorAccumulator normalize("normalize");
+    ErrorAccumulator log2("log2");
+    ErrorAccumulator exp2("exp2");
+    ErrorAccumulator pow("pow (specular)");
+
+    for (int i = 0; i < samples; ++i) {
+        // Squared lengths seen when normalizing normals, light and reflection vectors
+        float x = std::exp2(gen.next(-20.0f, 20.0f));
+        rsqrt.add(1.0 / std::sqrt(static_cast<double>(x)), fastRsqrt(x));
+
+        Vertex v = { gen.next(-10.0f, 10.0f), gen.next(-10.0f, 10.0f), gen.next(-10.0f, 10.0f) };
+        Vertex reference = v;
+        Vertex approximation = v;
+        normalizeVertex(reference);
+        fastNormalize(approximation);
+        normalize.add(reference.x, approximation.x);
+        normalize.add(reference.y, approximation.y);
+        normalize.add(reference.z, approximation.z);
+
+        float y = gen.next(1e-6f, 1.0f);
+        log2.add(std::log2(static_cast<double>(y)), fastLog2(y));
+
+        float e = gen.next(-60.0f, 0.0f);
+        exp2.add(std::exp2(static_cast<double>(e)), fastExp2(e));
+
+        // The shader raises max(reflected.z, 0) in [0, 1] to a specular exponent in [0, 255]
+        float base = gen.next(0.0f, 1.0f);
+        float exponent = std::floor(gen.next(0.0f, 256.0f));
+        pow.add(std::pow(static_cast<double>(base), static_cast<double>(exponent)), fastPow(base, exponent));
+    }
+
+    std::vector<KernelError> report = { rsqrt.result(), normalize.result(), log2.result(), exp2.result(), pow.result() };
+
+#ifdef RASTERIZER_SSE
+    // The four-wide kernels must agree with their scalar counterparts' error bounds
+    ErrorAccumulator normalize4("normalize (SSE)");
+    ErrorAccumulator pow4("pow (SSE)");
+    for (int i = 0; i < samples; i += 4) {
+        alignas(16) float vx[4], vy[4], vz[4], base[4], exponent[4], result[4];
+        for (int lane = 0; lane < 4; ++lane) {
+            vx[lane] = gen.next(-10.0f, 10.0f);
+            vy[lane] = gen.next(-10.0f, 10.0f);
+            vz[lane] = gen.next(-10.0f, 10.0f);
+            base[lane] = gen.next(0.0f, 1.0f);
+            exponent[lane] = std::floor(gen.next(0.0f, 256.0f));
+        }
+
+        __m128 x = _mm_load_ps(vx), y = _mm_load_ps(vy), z = _mm_load_ps(vz);
+        fastNormalize4(x, y, z);
+        _mm_store_ps(result, x);
+        for (int lane = 0; lane < 4; ++lane) {
+            Vertex reference = { vx[lane], vy[lane], vz[lane] };
+            normalizeVertex(reference);
+            normalize4.add(reference.x, result[lane]);
+        }
+
+        _mm_store_ps(result, fastPow4(_mm_load_ps(base), _mm_load_ps(exponent)));
+        for (int lane = 0; lane < 4; ++lane) {
+            pow4.add(std::pow(static_cast<double>(base[lane]), static_cast<double>(exponent[lane])), result[lane]);
+        }
+    }
+    report.push_back(normalize4.result());
+    report.push_back(pow4.result());
+#endif
+
+    return report;
+}
+
+// Function to print the accuracy report as a table
+void printShadingMathReport(const std::vector<KernelError>& report) {
+    printf("Fast shading math accuracy (vs reference):\n");
+    printf("  %-18s %12s %12s %12s %9s\n", "kernel", "max abs", "max rel", "mean abs", "samples");
+    for (const KernelError& error : report) {
+        printf("  %-18s %12.3e %12.3e %12.3e %9d\n", error.name, error.maxAbsError, error.maxRelError, error.meanAbsError, error.samples);
+    }
+}
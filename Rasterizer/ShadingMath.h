@@ -0,0 +1,185 @@
+#pragma once
+
+#include "Structs.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RASTERIZER_SSE 1
+#include <emmintrin.h>
+#endif
+
+// Selects between the exact math library and the approximate kernels below
+enum class ShaderQuality {
+    Reference, // sqrt, divides and std::pow
+    Fast       // rsqrt with one Newton step and exp2/log2 polynomials
+};
+
+// Approximate 1/sqrt(x) for x > 0, relative error below 1e-6
+inline float fastRsqrt(float x) {
+#ifdef RASTERIZER_SSE
+    float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+    return y * (1.5f - 0.5f * x * y * y);
+#else
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    bits = 0x5f375a86 - (bits >> 1);
+    float y;
+    std::memcpy(&y, &bits, sizeof(y));
+    y = y * (1.5f - 0.5f * x * y * y);
+    return y * (1.5f - 0.5f * x * y * y);
+#endif
+}
+
+// Approximate log2(x) for normal x > 0, absolute error below 3e-6
+inline float fastLog2(float x) {
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    float exponent = static_cast<float>(static_cast<int>((bits >> 23) & 0xFF) - 127);
+
+    // Map the mantissa to [1, 2) and evaluate log2(1 + t) with a minimax polynomial
+    bits = (bits & 0x007FFFFF) | 0x3F800000;
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+    float t = m - 1.0f;
+    float p = -0.0257923372f;
+    p = p * t + 0.121472925f;
+    p = p * t - 0.27734162f;
+    p = p * t + 0.457158108f;
+    p = p * t - 0.718033588f;
+    p = p * t + 1.44253478f;
+    return exponent + p * t;
+}
+
+// Approximate 2^x, relative error below 2e-7; x is clamped to the normal float range
+inline float fastExp2(float x) {
+    x = std::min(std::max(x, -126.0f), 127.0f);
+    float whole = std::floor(x);
+    float t = x - whole;
+
+    // 2^t for t in [0, 1), then add the integer part straight into the exponent bits
+    float p = 0.00189510704f;
+    p = p * t + 0.00894621529f;
+    p = p * t + 0.0558632821f;
+    p = p * t + 0.24014077f;
+    p = p * t + 0.69315462f;
+    p = p * t + 0.999999896f;
+
+    int32_t bits;
+    std::memcpy(&bits, &p, sizeof(bits));
+    bits += static_cast<int32_t>(whole) << 23;
+    std::memcpy(&p, &bits, sizeof(p));
+    return p;
+}
+
+// Approximate pow(x, y) for x >= 0 as exp2(y * log2(x)); matches std::pow for x == 0
+inline float fastPow(float x, float y) {
+    float result = fastExp2(y * fastLog2(std::max(x, 1e-30f)));
+    return x > 0.0f ? result : (y == 0.0f ? 1.0f : 0.0f);
+}
+
+// Normalize using rsqrt and multiplies; zero-length vectors stay zero
+inline void fastNormalize(Vertex& v) {
+    float length = v.x * v.x + v.y * v.y + v.z * v.z;
+    float invLength = fastRsqrt(std::max(length, 1e-30f));
+    v.x *= invLength;
+    v.y *= invLength;
+    v.z *= invLength;
+}
+
+// Normalize with the kernel matching the requested quality
+inline void normalizeVertex(Vertex& v, ShaderQuality quality) {
+    if (quality == ShaderQuality::Fast) {
+        fastNormalize(v);
+    }
+    else {
+        normalizeVertex(v);
+    }
+}
+
+// pow with the kernel matching the requested quality
+inline float shadingPow(float x, float y, ShaderQuality quality) {
+    return quality == ShaderQuality::Fast ? fastPow(x, y) : std::pow(x, y);
+}
+
+#ifdef RASTERIZER_SSE
+// Four-wide 1/sqrt(x) with one Newton step
+inline __m128 fastRsqrt4(__m128 x) {
+    __m128 y = _mm_rsqrt_ps(x);
+    __m128 yy = _mm_mul_ps(y, y);
+    return _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), x), yy)));
+}
+
+// Normalize four vectors stored as separate x, y and z lanes
+inline void fastNormalize4(__m128& x, __m128& y, __m128& z) {
+    __m128 length = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+    __m128 invLength = fastRsqrt4(_mm_max_ps(length, _mm_set1_ps(1e-30f)));
+    x = _mm_mul_ps(x, invLength);
+    y = _mm_mul_ps(y, invLength);
+    z = _mm_mul_ps(z, invLength);
+}
+
+// Four-wide fastLog2
+inline __m128 fastLog24(__m128 x) {
+    __m128i bits = _mm_castps_si128(x);
+    __m128i biased = _mm_and_si128(_mm_srli_epi32(bits, 23), _mm_set1_epi32(0xFF));
+    __m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(biased, _mm_set1_epi32(127)));
+
+    __m128i mantissa = _mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000));
+    __m128 t = _mm_sub_ps(_mm_castsi128_ps(mantissa), _mm_set1_ps(1.0f));
+    __m128 p = _mm_set1_ps(-0.0257923372f);
+    p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(0.121472925f));
+    p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(-0.27734162f));
+    p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(0.457158108f));
+    p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(-0.718033588f));
+    p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(1.44253478f));
+    return _mm_add_ps(exponent, _mm_mul_ps(p, t));
+}
+
+// Four-wide fastExp2
+inline __m128 fastExp24(__m128 x) {
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-126.0f)), _mm_set1_ps(127.0f));
+
+    // floor() without SSE4.1: truncate, then step down where truncation rounded up
+    __m128i whole = _mm_cvttps_epi32(x);
+    __m128 wholeF = _mm_cvtepi32_ps(whole);
+    __m128 roundedUp = _mm_cmpgt_ps(wholeF, x);
+    whole = _mm_add_epi32(whole, _mm_castps_si128(roundedUp));
+    wholeF = _mm_sub_ps(wholeF, _mm_and_ps(roundedUp, _mm_set1_ps(1.0f)));
+    __m128 t = _mm_sub_ps(x, wholeF);
+
+    __m128 p = _mm_set1_ps(0.00189510704f);
+    p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(0.00894621529f));
+    p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(0.0558632821f));
+    p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(0.24014077f));
+    p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(0.69315462f));
+    p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(0.999999896f));
+    return _mm_castsi128_ps(_mm_add_epi32(_mm_castps_si128(p), _mm_slli_epi32(whole, 23)));
+}
+
+// Four-wide fastPow, including the x == 0 cases of std::pow
+inline __m128 fastPow4(__m128 x, __m128 y) {
+    __m128 result = fastExp24(_mm_mul_ps(y, fastLog24(_mm_max_ps(x, _mm_set1_ps(1e-30f)))));
+    __m128 positive = _mm_cmpgt_ps(x, _mm_setzero_ps());
+    __m128 zeroPower = _mm_and_ps(_mm_cmpeq_ps(y, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    return _mm_or_ps(_mm_and_ps(positive, result), _mm_andnot_ps(positive, zeroPower));
+}
+#endif
+
+// Error of one approximate kernel measured against the reference implementation
+struct KernelError {
+    const char* name;    // Kernel name
+    double maxAbsError;  // Largest absolute error
+    double maxRelError;  // Largest relative error where the reference is not tiny
+    double meanAbsError; // Mean absolute error
+    int samples;         // Number of inputs evaluated
+};
+
+// Sweep the input ranges used by the Phong shader and compare every fast kernel with the reference path
+std::vector<KernelError> measureShadingMathAccuracy(int samples = 100000);
+
+// Print an accuracy report to stdout
+void printShadingMathReport(const std::vector<KernelError>& report);
@@ -1,5 +1,6 @@
 #pragma	once
 
+#include <cstring>
 #include <fstream>
 
 #pragma pack(push,1)
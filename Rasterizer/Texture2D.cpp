@@ -0,0 +1,50 @@
+#include "Texture2D.h"
+#include <iostream>
+
+// Constructor: Initializes an empty texture
+Texture2D::Texture2D() : width(0), height(0) {
+}
+
+// Function to convert a TGA image into RGBA8 texels
+bool Texture2D::loadFromTGA(TGAImage& image) {
+    int bytespp = image.get_bytespp();
+    const unsigned char* src = image.buffer();
+    if (!src || (bytespp != TGAImage::GRAYSCALE && bytespp != TGAImage::RGB && bytespp != TGAImage::RGBA)) {
+        std::cerr << "can't convert an empty or unsupported TGA image to a texture\n";
+        return false;
+    }
+
+    create(image.get_width(), image.get_height());
+
+    // TGA stores pixels as BGR(A); grayscale is replicated to all three color channels
+    for (size_t i = 0; i < texels.size(); ++i, src += bytespp) {
+        Texel& t = texels[i];
+        if (bytespp == TGAImage::GRAYSCALE) {
+            t = { src[0], src[0], src[0], 255 };
+        }
+        else {
+            t = { src[2], src[1], src[0], static_cast<unsigned char>(bytespp == TGAImage::RGBA ? src[3] : 255) };
+        }
+    }
+
+    return true;
+}
+
+// Function to read a TGA file and convert it into a texture
+bool Texture2D::loadFromFile(const char* filename, bool flipVertically) {
+    TGAImage image;
+    if (!image.read_tga_file(filename)) {
+        return false;
+    }
+    if (flipVertically) {
+        image.flip_vertically();
+    }
+    return loadFromTGA(image);
+}
+
+// Function to allocate a cleared texture
+void Texture2D::create(int w, int h) {
+    width = w;
+    height = h;
+    texels.assign(static_cast<size_t>(width) * height, Texel{ 0, 0, 0, 0 });
+}
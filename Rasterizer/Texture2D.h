@@ -0,0 +1,91 @@
+#pragma once
+
+#include "TGAImage.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Texel stored in a fixed 32-bit RGBA8 layout
+struct Texel {
+    unsigned char r; // Red channel
+    unsigned char g; // Green channel
+    unsigned char b; // Blue channel
+    unsigned char a; // Alpha channel
+};
+
+// Addressing mode used when texture coordinates fall outside [0, 1]
+enum class TextureWrap {
+    Repeat, // Tile the texture
+    Clamp   // Stretch the edge texels
+};
+
+// Map normalized texture coordinates to a row-major texel index using the given addressing mode
+template <TextureWrap Wrap>
+inline int texelIndex(float u, float v, int width, int height) {
+    if (Wrap == TextureWrap::Repeat) {
+        // Keep only the fractional part so that the coordinate tiles
+        u -= std::floor(u);
+        v -= std::floor(v);
+    }
+
+    // Scale to texel space; min/max compile to branch-free selects
+    int x = std::min(std::max(static_cast<int>(u * width), 0), width - 1);
+    int y = std::min(std::max(static_cast<int>(v * height), 0), height - 1);
+    return y * width + x;
+}
+
+// Texture converted once from a TGA image into RGBA8 texels so fetches don't depend on bytespp
+class Texture2D {
+public:
+    // Constructor for an empty texture
+    Texture2D();
+
+    // Convert a grayscale, RGB or RGBA TGA image into RGBA8 texels
+    bool loadFromTGA(TGAImage& image);
+
+    // Read a TGA file and convert it, flipping it so that v = 0 is the bottom row
+    bool loadFromFile(const char* filename, bool flipVertically = true);
+
+    // Allocate a texture of the given size with all texels cleared to zero
+    void create(int w, int h);
+
+    // Fetch the texel at integer coordinates (no addressing applied)
+    Texel fetch(int x, int y) const;
+
+    // Sample the nearest texel at normalized texture coordinates
+    template <TextureWrap Wrap = TextureWrap::Repeat>
+    Texel sample(float u, float v) const;
+
+    int getWidth() const;
+
+    int getHeight() const;
+
+    // Raw texel storage, row-major
+    const Texel* data() const;
+
+private:
+    std::vector<Texel> texels; // RGBA8 texels
+    int width;                 // Texture width in texels
+    int height;                // Texture height in texels
+};
+
+inline Texel Texture2D::fetch(int x, int y) const {
+    return texels[y * width + x];
+}
+
+template <TextureWrap Wrap>
+inline Texel Texture2D::sample(float u, float v) const {
+    return texels[texelIndex<Wrap>(u, v, width, height)];
+}
+
+inline int Texture2D::getWidth() const {
+    return width;
+}
+
+inline int Texture2D::getHeight() const {
+    return height;
+}
+
+inline const Texel* Texture2D::data() const {
+    return texels.data();
+}
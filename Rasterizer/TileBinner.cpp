@@ -0,0 +1,88 @@
+#include "TileBinner.h"
+#include "Profiler.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <cstring>
+
+// Constructor: An empty grid, so getTile is never called before bin()
+TileBinner::TileBinner() : width(0), height(0), tilesX(0), tilesY(0), busyTiles(0), tileStart(nullptr), indices(nullptr) {
+}
+
+// Function to count, then write, every thread's entries
+void TileBinner::bin(const BinnedTriangle* triangles, size_t count, int newWidth, int newHeight, JobSystem& jobs, FrameArena& arena) {
+    PROFILE_SCOPE(ProfileStage::Binning);
+    TRACE_SCOPE("Bin");
+    width = newWidth;
+    height = newHeight;
+    tilesX = (width + TileClearState::TileSize - 1) >> TileClearState::TileShift;
+    tilesY = (height + TileClearState::TileSize - 1) >> TileClearState::TileShift;
+    const int tileCount = tilesX * tilesY;
+
+    // Contiguous ranges keep each thread's entries in primitive order
+    size_t usefulThreads = std::max<size_t>(1, count / MinTrianglesPerThread);
+    const int threads = static_cast<int>(std::min<size_t>(jobs.getThreadCount(), usefulThreads));
+    auto rangeBegin = [count, threads](int thread) {
+        return count * thread / threads;
+    };
+
+    // One row of counts per thread; the prefix sum turns them into write cursors in place
+    uint32_t* cursors = arena.allocate<uint32_t>(static_cast<size_t>(threads) * tileCount);
+    std::memset(cursors, 0, sizeof(uint32_t) * threads * tileCount);
+    tileStart = arena.allocate<uint32_t>(tileCount + 1);
+
+    // One range per job, so the ranges and the order of their entries don't depend on which thread runs them
+    auto parallel = [&jobs, threads](auto function) {
+        jobs.parallelFor(threads, 1, [&function](size_t begin, size_t end) {
+            for (size_t thread = begin; thread < end; ++thread) {
+                function(static_cast<int>(thread));
+            }
+        });
+    };
+
+    parallel([&](int thread) {
+        countRange(triangles, rangeBegin(thread), rangeBegin(thread + 1), cursors + static_cast<size_t>(thread) * tileCount);
+    });
+
+    uint32_t total = 0;
+    busyTiles = 0;
+    for (int tile = 0; tile < tileCount; ++tile) {
+        tileStart[tile] = total;
+        for (int thread = 0; thread < threads; ++thread) {
+            uint32_t& cursor = cursors[static_cast<size_t>(thread) * tileCount + tile];
+            uint32_t entries = cursor;
+            cursor = total;
+            total += entries;
+        }
+        busyTiles += total != tileStart[tile] ? 1 : 0;
+    }
+    tileStart[tileCount] = total;
+    indices = arena.allocate<uint32_t>(total);
+
+    parallel([&](int thread) {
+        writeRange(triangles, rangeBegin(thread), rangeBegin(thread + 1), cursors + static_cast<size_t>(thread) * tileCount);
+    });
+}
+
+void TileBinner::countRange(const BinnedTriangle* triangles, size_t begin, size_t end, uint32_t* counts) const {
+    const int shift = TileClearState::TileShift;
+    for (size_t i = begin; i < end; ++i) {
+        const PixelRect& bounds = triangles[i].bounds;
+        for (int ty = bounds.minY >> shift; ty <= bounds.maxY >> shift; ++ty) {
+            for (int tx = bounds.minX >> shift; tx <= bounds.maxX >> shift; ++tx) {
+                counts[ty * tilesX + tx]++;
+            }
+        }
+    }
+}
+
+void TileBinner::writeRange(const BinnedTriangle* triangles, size_t begin, size_t end, uint32_t* cursors) {
+    const int shift = TileClearState::TileShift;
+    for (size_t i = begin; i < end; ++i) {
+        const PixelRect& bounds = triangles[i].bounds;
+        for (int ty = bounds.minY >> shift; ty <= bounds.maxY >> shift; ++ty) {
+            for (int tx = bounds.minX >> shift; tx <= bounds.maxX >> shift; ++tx) {
+                indices[cursors[ty * tilesX + tx]++] = static_cast<uint32_t>(i);
+            }
+        }
+    }
+}
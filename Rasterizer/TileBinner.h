@@ -0,0 +1,109 @@
+#pragma once
+
+#include "FrameArena.h"
+#include "JobSystem.h"
+#include "RenderTarget.h"
+#include "Structs.h"
+#include "TileClearState.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// A triangle that survived the geometry stage
+struct BinnedTriangle {
+    Vertex screenCoord[3]; // Screen-space corners
+    TexCoord uv[3];        // Texture coordinates of the corners
+    uint32_t draw;         // Index of the draw that produced it
+    PixelRect bounds;      // Bounding box clipped to the target
+};
+
+// Triangle indices of one tile, in primitive order
+struct TileList {
+    const uint32_t* indices;
+    uint32_t count;
+};
+
+// Sorts triangles into the screen tiles their bounding boxes overlap (TileClearState's 64x64 grid). Every tile gets a
+// compact list of triangle indices in primitive order, packed one after another in a single array in a frame arena.
+//
+// Binning runs in two passes over contiguous ranges of the triangles, one range per job system thread, each range a
+// job. The first pass counts each range's entries per tile; a prefix sum over tiles, then ranges, gives every range its
+// own write cursor in every tile's list, after the entries of the ranges before it. The second pass writes the indices
+// through those cursors. No job ever writes where another does, so appending takes no locks or atomics, and merging the
+// per-range sub-bins costs nothing because they were laid out in order. All storage comes from the arena.
+class TileBinner {
+public:
+    // Ranges smaller than this are not worth a job
+    static const size_t MinTrianglesPerThread = 16 * 1024;
+
+    // Constructor: no tiles until the first bin()
+    TileBinner();
+
+    // Bin triangles for a width x height target on up to every thread of jobs. The lists live in arena and stay valid
+    // until it is reset or bin() is called again.
+    void bin(const BinnedTriangle* triangles, size_t count, int width, int height, JobSystem& jobs, FrameArena& arena);
+
+    // Triangle indices overlapping a tile
+    TileList getTile(int tile) const;
+
+    // Pixel rectangle of a tile, clipped to the target
+    PixelRect getTileRect(int tile) const;
+
+    int getTileCount() const;
+
+    // Tile grid; tile t is in column t % getTilesX() and row t / getTilesX()
+    int getTilesX() const;
+
+    int getTilesY() const;
+
+    // Tiles with at least one triangle
+    int getBusyTileCount() const;
+
+    // Entries over all tiles: a triangle counts once per tile it overlaps
+    size_t getEntryCount() const;
+
+private:
+    // Count one range's entries per tile into its row of counts
+    void countRange(const BinnedTriangle* triangles, size_t begin, size_t end, uint32_t* counts) const;
+
+    // Write one range's indices through its row of cursors
+    void writeRange(const BinnedTriangle* triangles, size_t begin, size_t end, uint32_t* cursors);
+
+    int width;              // Target size
+    int height;
+    int tilesX;             // Tile grid
+    int tilesY;
+    int busyTiles;          // Tiles with entries
+    uint32_t* tileStart;    // tileCount + 1 offsets into indices; tile t owns [tileStart[t], tileStart[t + 1])
+    uint32_t* indices;      // Every tile's list, one after another
+};
+
+inline TileList TileBinner::getTile(int tile) const {
+    return { indices + tileStart[tile], tileStart[tile + 1] - tileStart[tile] };
+}
+
+inline PixelRect TileBinner::getTileRect(int tile) const {
+    int x0 = (tile % tilesX) << TileClearState::TileShift;
+    int y0 = (tile / tilesX) << TileClearState::TileShift;
+    return { x0, y0, std::min(x0 + TileClearState::TileSize, width) - 1, std::min(y0 + TileClearState::TileSize, height) - 1 };
+}
+
+inline int TileBinner::getTileCount() const {
+    return tilesX * tilesY;
+}
+
+inline int TileBinner::getTilesX() const {
+    return tilesX;
+}
+
+inline int TileBinner::getTilesY() const {
+    return tilesY;
+}
+
+inline int TileBinner::getBusyTileCount() const {
+    return busyTiles;
+}
+
+inline size_t TileBinner::getEntryCount() const {
+    return tilesX * tilesY > 0 ? tileStart[tilesX * tilesY] : 0;
+}
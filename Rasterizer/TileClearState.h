@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Tracks which tiles of a screen-sized buffer hold data written since the last clear.
+// clear() only bumps a generation counter; a stale tile is initialized the first time a draw touches it,
+// so tiles that nothing covers are never written at all.
+class TileClearState {
+public:
+    static const int TileShift = 6;              // Tiles are 64x64 pixels
+    static const int TileSize = 1 << TileShift;
+
+    // Constructor: every tile starts stale
+    TileClearState(int width, int height);
+
+    // Resize the tile grid; every tile becomes stale
+    void reset(int width, int height);
+
+    // Mark every tile stale
+    void clear();
+
+    // Run init(x0, y0, x1, y1) on the pixel rectangle of each stale tile overlapping [minX, maxX] x [minY, maxY],
+    // then mark those tiles current. Coordinates are inclusive and must lie inside the buffer.
+    template <typename InitFn>
+    void touch(int minX, int minY, int maxX, int maxY, InitFn init);
+
+    // True when the tile containing the pixel was initialized since the last clear
+    bool isCurrent(int x, int y) const;
+
+    int getTilesX() const;
+
+    int getTilesY() const;
+
+private:
+    int width;                          // Buffer width in pixels
+    int height;                         // Buffer height in pixels
+    int tilesX;                         // Number of tile columns
+    int tilesY;                         // Number of tile rows
+    uint32_t generation;                // Incremented by every clear
+    std::vector<uint32_t> tileGeneration; // Generation each tile was last initialized in
+};
+
+inline TileClearState::TileClearState(int width, int height) {
+    reset(width, height);
+}
+
+inline void TileClearState::reset(int newWidth, int newHeight) {
+    width = newWidth;
+    height = newHeight;
+    tilesX = (width + TileSize - 1) >> TileShift;
+    tilesY = (height + TileSize - 1) >> TileShift;
+    generation = 1;
+    tileGeneration.assign(static_cast<size_t>(tilesX) * tilesY, 0u);
+}
+
+inline void TileClearState::clear() {
+    // On wrap-around restart the counters so an old tile can't look current
+    if (++generation == 0) {
+        std::fill(tileGeneration.begin(), tileGeneration.end(), 0u);
+        generation = 1;
+    }
+}
+
+template <typename InitFn>
+inline void TileClearState::touch(int minX, int minY, int maxX, int maxY, InitFn init) {
+    int tileMinX = minX >> TileShift;
+    int tileMaxX = maxX >> TileShift;
+    int tileMinY = minY >> TileShift;
+    int tileMaxY = maxY >> TileShift;
+
+    for (int ty = tileMinY; ty <= tileMaxY; ++ty) {
+        for (int tx = tileMinX; tx <= tileMaxX; ++tx) {
+            uint32_t& tile = tileGeneration[ty * tilesX + tx];
+            if (tile != generation) {
+                int x0 = tx << TileShift;
+                int y0 = ty << TileShift;
+                init(x0, y0, std::min(x0 + TileSize, width) - 1, std::min(y0 + TileSize, height) - 1);
+                tile = generation;
+            }
+        }
+    }
+}
+
+inline bool TileClearState::isCurrent(int x, int y) const {
+    return tileGeneration[(y >> TileShift) * tilesX + (x >> TileShift)] == generation;
+}
+
+inline int TileClearState::getTilesX() const {
+    return tilesX;
+}
+
+inline int TileClearState::getTilesY() const {
+    return tilesY;
+}
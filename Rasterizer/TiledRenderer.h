@@ -0,0 +1,242 @@
+#pragma once
+
+#include "FrameArena.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "RenderCommandBuffer.h"
+#include "RenderTarget.h"
+#include "Renderer.h"
+#include "Scene.h"
+#include "TileBinner.h"
+#include "TraceRecorder.h"
+#include "View.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Renders draws tile by tile, with the tiles shared out as jobs of a JobSystem.
+// The result is bit-identical whatever the thread count, and identical to executing the same sorted commands with
+// renderInstance: a tile is only ever rasterized by one thread, its triangles are kept in primitive order (draw
+// order, then face order within a draw), and rasterizeTriangle gives a pixel the same coverage, depth and shading
+// whichever rectangle it is rasterized through. Depth ties therefore resolve the same way on every run, which makes
+// the output safe to cache and diff. Thread timing only decides which thread takes a tile, never what the tile holds.
+// Use setup, bin and rasterize once per frame in that order, or render to do all three. Transformed vertices, triangles
+// and bins live in a frame arena that setup resets, and the rest of the storage is kept between frames, so steady
+// frames make no heap allocations.
+// When the job system's workers span several NUMA nodes, each node rasterizes one band of tile rows, so the same node
+// clears, writes and keeps a tile's color and depth rows every frame; the first clear of a new target places them there.
+template <typename Shader>
+class TiledRenderer {
+public:
+    // Constructor: runs its jobs on JobSystem::instance()
+    TiledRenderer();
+
+    // Job system transforming, binning and rasterizing; must outlive the renderer or the next setJobSystem
+    void setJobSystem(JobSystem& jobs);
+
+    JobSystem& getJobSystem() const;
+
+    // Record, sort and render every instance of a scene. Like renderScene the target is not cleared first.
+    void render(const Scene& scene, const View& view, const Shader& shader, RenderTarget& target);
+
+    // Transform the draws of sorted commands for a target of the given size and keep the triangles that reach it.
+    // Each command is drawn with a copy of prototype given the command's uniforms; the draw's index is its draw id.
+    void setup(const RenderCommandBuffer& commands, const View& view, const Shader& prototype, const RenderTarget& target);
+
+    // List, for every tile, the triangles whose bounding box overlaps it, in primitive order (see TileBinner)
+    void bin();
+
+    // Rasterize every tile's triangles into a target of the size given to setup, and clear the color of the tiles
+    // without triangles, so the target needs no resolve() afterwards
+    void rasterize(RenderTarget& target);
+
+    // Triangles kept by the last setup
+    size_t getTriangleCount() const;
+
+    // Bins of the last bin()
+    const TileBinner& getBinner() const;
+
+    // Storage of the current frame's transient data
+    const FrameArena& getArena() const;
+
+private:
+    // Rasterize or resolve the tiles [begin, end) as jobs
+    void rasterizeTiles(int begin, int end, RenderTarget& target);
+
+    // Rasterize the triangles of one tile
+    void rasterizeTile(int tile, RenderTarget& target) const;
+
+    static_assert(isCopyableShader<Shader>, "Shader is copied by value, so it must be a final shader type such as PhongShader, not the shaderProgram interface");
+
+    JobSystem* jobs;                            // Runs the vertex, binning and raster jobs
+    int width;                                  // Target size given to setup
+    int height;
+    RenderCommandBuffer commands;               // Draws of render()
+    Shader commandShader;                       // Shader the draws of render() are recorded with
+    std::vector<Shader> draws;                  // Shader state of each draw: uniforms and material
+    FrameArena arena;                           // Per-frame storage of the vertices, triangles and bins
+    BinnedTriangle* triangles;                  // Visible triangles in primitive order, in the arena
+    size_t triangleCount;
+    TileBinner binner;                          // Triangle indices per tile, in primitive order
+};
+
+template <typename Shader>
+TiledRenderer<Shader>::TiledRenderer() : jobs(&JobSystem::instance()), width(0), height(0), triangles(nullptr), triangleCount(0) {
+}
+
+template <typename Shader>
+void TiledRenderer<Shader>::setJobSystem(JobSystem& newJobs) {
+    jobs = &newJobs;
+}
+
+template <typename Shader>
+JobSystem& TiledRenderer<Shader>::getJobSystem() const {
+    return *jobs;
+}
+
+template <typename Shader>
+size_t TiledRenderer<Shader>::getTriangleCount() const {
+    return triangleCount;
+}
+
+template <typename Shader>
+const TileBinner& TiledRenderer<Shader>::getBinner() const {
+    return binner;
+}
+
+template <typename Shader>
+const FrameArena& TiledRenderer<Shader>::getArena() const {
+    return arena;
+}
+
+// Function to run every stage for one scene
+template <typename Shader>
+void TiledRenderer<Shader>::render(const Scene& scene, const View& view, const Shader& shader, RenderTarget& target) {
+    commandShader = shader;
+    commands.clear();
+    commands.recordScene(scene, commandShader);
+    commands.sort(view.viewMatrix);
+    setup(commands, view, shader, target);
+    bin();
+    rasterize(target);
+}
+
+// Function to transform each draw's vertices and keep the triangles that reach the target
+template <typename Shader>
+void TiledRenderer<Shader>::setup(const RenderCommandBuffer& sortedCommands, const View& view, const Shader& prototype,
+    const RenderTarget& target) {
+    TRACE_SCOPE("Geometry");
+    arena.reset();
+    width = target.getWidth();
+    height = target.getHeight();
+    const Matrix viewProjection = view.projection * view.viewMatrix;
+    const Matrix viewportTransform = target.getViewport();
+    draws.clear();
+
+    // Room for every face and the largest mesh; culled faces leave part of the triangle array unused
+    size_t faceCount = 0;
+    size_t maxVertexCount = 0;
+    for (size_t i = 0; i < sortedCommands.size(); ++i) {
+        const Model& mesh = *sortedCommands.getCommand(i).mesh;
+        faceCount += mesh.getFaces().size();
+        maxVertexCount = std::max(maxVertexCount, mesh.getVertices().size());
+    }
+    triangles = arena.allocate<BinnedTriangle>(faceCount);
+    triangleCount = 0;
+    Vertex* screenCoords = arena.allocate<Vertex>(maxVertexCount);
+
+    for (size_t i = 0; i < sortedCommands.size(); ++i) {
+        const RenderCommand& command = sortedCommands.getCommand(i);
+        draws.push_back(prototype);
+        Shader& shader = draws.back();
+        shader.setTransforms(viewProjection, command.modelMatrix, viewportTransform, view.lightDirection);
+        shader.uniform_Material = command.material;
+
+        transformVertices(*command.mesh, shader, screenCoords, *jobs);
+        const std::vector<TexCoord>& texCoords = command.mesh->getTexCoords();
+        const size_t keptBefore = triangleCount;
+        for (const Face& face : command.mesh->getFaces()) {
+            BinnedTriangle triangle;
+            for (int corner = 0; corner < 3; ++corner) {
+                triangle.screenCoord[corner] = screenCoords[face.vertexIndex[corner]];
+                triangle.uv[corner] = texCoords[face.texCoordIndex[corner]];
+            }
+            if (triangleBounds(triangle.screenCoord, width, height, triangle.bounds)) {
+                triangle.draw = static_cast<uint32_t>(i);
+                triangles[triangleCount++] = triangle;
+            }
+        }
+        const size_t faces = command.mesh->getFaces().size();
+        PROFILE_COUNT(ProfileCounter::TrianglesIn, faces);
+        PROFILE_COUNT(ProfileCounter::TrianglesCulled, faces - (triangleCount - keptBefore));
+    }
+}
+
+// Function to bin the triangles kept by setup
+template <typename Shader>
+void TiledRenderer<Shader>::bin() {
+    binner.bin(triangles, triangleCount, width, height, *jobs, arena);
+}
+
+// Function to rasterize the tiles, giving each NUMA node a contiguous band of tile rows. A tile's rows are contiguous
+// in memory, so apart from the pages at a band's edges every page of the target is only ever touched by one node.
+template <typename Shader>
+void TiledRenderer<Shader>::rasterize(RenderTarget& target) {
+    const int nodes = jobs->getNodeCount();
+    if (nodes == 1) {
+        rasterizeTiles(0, binner.getTileCount(), target);
+        return;
+    }
+
+    Job* group = jobs->createGroup();
+    for (int node = 0; node < nodes; ++node) {
+        jobs->run(jobs->create([this, &target, node, nodes] {
+            const int tilesX = binner.getTilesX();
+            const int tilesY = binner.getTilesY();
+            rasterizeTiles(node * tilesY / nodes * tilesX, (node + 1) * tilesY / nodes * tilesX, target);
+        }, group), node);
+    }
+    jobs->run(group);
+    jobs->wait(group);
+}
+
+// Function to rasterize a run of tiles as jobs, one tile at a time so a busy tile doesn't hold back a range of others.
+// Tiles without triangles are cleared by the job too, which keeps their first touch on the thread's node.
+template <typename Shader>
+void TiledRenderer<Shader>::rasterizeTiles(int begin, int end, RenderTarget& target) {
+    jobs->parallelFor(static_cast<size_t>(end - begin), 1, [this, &target, begin](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            const int tile = begin + static_cast<int>(i);
+            if (binner.getTile(tile).count != 0) {
+                rasterizeTile(tile, target);
+            }
+            else {
+                target.resolve(binner.getTileRect(tile));
+            }
+        }
+    });
+}
+
+// Function to rasterize one tile's triangles in primitive order, so overlapping triangles and depth ties resolve as
+// they would on one thread. Rasterizing writes the shader's uvCoord, so the tile draws with its own copy of each
+// draw's shader, taken when the draw changes.
+template <typename Shader>
+void TiledRenderer<Shader>::rasterizeTile(int tile, RenderTarget& target) const {
+    TRACE_SCOPE("Raster tile");
+    PROFILE_SCOPE(ProfileStage::Rasterization);
+    const PixelRect scissor = binner.getTileRect(tile);
+    const TileList list = binner.getTile(tile);
+    Shader shader = draws[triangles[list.indices[0]].draw];
+    uint32_t loadedDraw = triangles[list.indices[0]].draw;
+    for (uint32_t i = 0; i < list.count; ++i) {
+        BinnedTriangle& triangle = triangles[list.indices[i]];
+        if (triangle.draw != loadedDraw) {
+            shader = draws[triangle.draw];
+            loadedDraw = triangle.draw;
+        }
+        shader.uvCoord[0] = triangle.uv[0];
+        shader.uvCoord[1] = triangle.uv[1];
+        shader.uvCoord[2] = triangle.uv[2];
+        renderTriangle(triangle.screenCoord, shader, target, scissor, triangle.draw);
+    }
+}
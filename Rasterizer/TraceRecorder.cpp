@@ -0,0 +1,157 @@
+#include "TraceRecorder.h"
+#include <stdio.h>
+
+// Constructor: The trace's time origin is the first use of the recorder
+TraceRecorder::TraceRecorder() : start(std::chrono::steady_clock::now()), enabled(false), dropped(0) {
+}
+
+// Constructor: No chunks yet
+TraceRecorder::ThreadBuffer::ThreadBuffer() : count(0), firstEvent(0), threadId(0) {
+    for (std::atomic<TraceEvent*>& chunk : chunks) {
+        chunk.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+// Destructor: Free the chunks; the recorder only destroys buffers when nothing records or reads any more
+TraceRecorder::ThreadBuffer::~ThreadBuffer() {
+    for (std::atomic<TraceEvent*>& chunk : chunks) {
+        delete[] chunk.load(std::memory_order_relaxed);
+    }
+}
+
+// Function to get the process-wide recorder
+TraceRecorder& TraceRecorder::instance() {
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+void TraceRecorder::setEnabled(bool newEnabled) {
+    enabled.store(newEnabled, std::memory_order_relaxed);
+}
+
+bool TraceRecorder::isEnabled() const {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+uint64_t TraceRecorder::now() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Function to find the calling thread's buffer, registering it on first use. The recorder owns the buffer,
+// so events survive the thread.
+TraceRecorder::ThreadBuffer& TraceRecorder::localBuffer() {
+    static thread_local ThreadBuffer* buffer = nullptr;
+    if (buffer == nullptr) {
+        std::unique_ptr<ThreadBuffer> created(new ThreadBuffer());
+        std::lock_guard<std::mutex> lock(mutex);
+        created->threadId = static_cast<uint32_t>(buffers.size()) + 1;
+        buffer = created.get();
+        buffers.push_back(std::move(created));
+    }
+    return *buffer;
+}
+
+// Function to append an event; only the owning thread writes its buffer
+void TraceRecorder::record(const char* name, uint64_t beginNs, uint64_t endNs) {
+    ThreadBuffer& buffer = localBuffer();
+    size_t index = buffer.count.load(std::memory_order_relaxed);
+    if (index >= MaxEventsPerThread) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Only this thread stores chunk pointers, so a relaxed load sees its own; the release store publishes a new chunk
+    // to the reader, which also finds it through the count's release below
+    std::atomic<TraceEvent*>& slot = buffer.chunks[index / ChunkSize];
+    TraceEvent* chunk = slot.load(std::memory_order_relaxed);
+    if (chunk == nullptr) {
+        chunk = new TraceEvent[ChunkSize];
+        slot.store(chunk, std::memory_order_release);
+    }
+
+    chunk[index % ChunkSize] = { name, beginNs, endNs };
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+// Function to label the calling thread
+void TraceRecorder::setThreadName(const std::string& name) {
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer.name = name;
+}
+
+// Function to drop the events recorded so far; they stay allocated but are skipped by later writes
+void TraceRecorder::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const std::unique_ptr<ThreadBuffer>& buffer : buffers) {
+        buffer->firstEvent = buffer->count.load(std::memory_order_acquire);
+    }
+    dropped.store(0, std::memory_order_relaxed);
+}
+
+// Function to count the events a write would contain
+size_t TraceRecorder::getEventCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t total = 0;
+    for (const std::unique_ptr<ThreadBuffer>& buffer : buffers) {
+        total += buffer->count.load(std::memory_order_acquire) - buffer->firstEvent;
+    }
+    return total;
+}
+
+uint64_t TraceRecorder::getDroppedCount() const {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+// Function to write the trace: one complete ("X") event per scope, with times in microseconds, and one metadata
+// event per named thread
+bool TraceRecorder::writeChromeTrace(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        printf("Error: can't open trace file %s\n", path.c_str());
+        return false;
+    }
+
+    // Buffers live as long as the recorder, so a snapshot of the list taken under the lock stays valid; the file is
+    // written without it, so a thread recording its first event never waits for the I/O
+    struct BufferView {
+        const ThreadBuffer* buffer;
+        size_t firstEvent;
+        std::string name;
+    };
+    std::vector<BufferView> views;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const std::unique_ptr<ThreadBuffer>& buffer : buffers) {
+            views.push_back({ buffer.get(), buffer->firstEvent, buffer->name });
+        }
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (const BufferView& view : views) {
+        const ThreadBuffer& buffer = *view.buffer;
+        if (!view.name.empty()) {
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}", first ? "" : ",\n",
+                buffer.threadId, view.name.c_str());
+            first = false;
+        }
+
+        // Events below the published count are complete and never change, and neither do their chunk pointers
+        size_t count = buffer.count.load(std::memory_order_acquire);
+        for (size_t i = view.firstEvent; i < count; ++i) {
+            const TraceEvent& event = buffer.chunks[i / ChunkSize].load(std::memory_order_acquire)[i % ChunkSize];
+            fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", first ? "" : ",\n", event.name,
+                buffer.threadId, event.beginNs * 1e-3, (event.endNs - event.beginNs) * 1e-3);
+            first = false;
+        }
+    }
+    fprintf(file, "\n]}\n");
+
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    if (ok) {
+        printf("Trace written to %s\n", path.c_str());
+    }
+    return ok;
+}
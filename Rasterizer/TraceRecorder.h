@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Profiler.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Timeline of what every thread did, written as Chrome trace JSON (open in chrome://tracing or ui.perfetto.dev).
+// Trace scopes are compiled in with RASTERIZER_TRACE, which is on by default in every build type since a scope costs
+// one relaxed atomic load while recording is off; recording is switched on and off at run time.
+//
+// Each thread appends to its own buffer and publishes an event by storing the new event count with release order.
+// A buffer's 4096-event chunks hang off a fixed table of atomic pointers, each published before the first event in it,
+// so neither recording nor writing the file takes a lock per buffer: the writer reads the published events of every
+// buffer while threads keep recording, and a thread starting a new chunk never waits for file I/O.
+
+// One completed scope
+struct TraceEvent {
+    const char* name;   // Static string
+    uint64_t beginNs;   // Nanoseconds since the recorder started
+    uint64_t endNs;
+};
+
+class TraceRecorder {
+public:
+    static const size_t ChunkSize = 4096;            // Events per allocation
+    static const size_t MaxEventsPerThread = 1 << 20; // Later events of a thread are dropped
+
+    // The process-wide recorder
+    static TraceRecorder& instance();
+
+    // Start or stop recording new scopes
+    void setEnabled(bool enabled);
+
+    bool isEnabled() const;
+
+    // Nanoseconds since the recorder started
+    uint64_t now() const;
+
+    // Append a completed scope to the calling thread's buffer
+    void record(const char* name, uint64_t beginNs, uint64_t endNs);
+
+    // Name the calling thread in the trace
+    void setThreadName(const std::string& name);
+
+    // Forget the events recorded so far; the trace restarts from here
+    void clear();
+
+    // Write every event recorded since the last clear as Chrome trace JSON; returns false if the file can't be written
+    bool writeChromeTrace(const std::string& path);
+
+    // Events recorded since the last clear, over all threads
+    size_t getEventCount();
+
+    // Events lost because a thread's buffer was full
+    uint64_t getDroppedCount() const;
+
+private:
+    static const size_t MaxChunks = MaxEventsPerThread / ChunkSize;
+
+    // Events of one thread
+    struct ThreadBuffer {
+        ThreadBuffer();
+        ~ThreadBuffer();
+
+        std::atomic<TraceEvent*> chunks[MaxChunks];         // Storage, allocated by the owning thread as it fills up
+        std::atomic<size_t> count;                          // Published events
+        size_t firstEvent;                                  // Events before this were cleared; guarded by mutex
+        uint32_t threadId;                                  // Id in the trace
+        std::string name;                                   // Thread name; guarded by mutex
+    };
+
+    TraceRecorder();
+
+    // Buffer of the calling thread, created on first use
+    ThreadBuffer& localBuffer();
+
+    std::chrono::steady_clock::time_point start;    // Time origin of the trace
+    std::atomic<bool> enabled;                      // Run-time switch
+    std::atomic<uint64_t> dropped;                  // Events lost to full buffers
+    std::mutex mutex;                               // Guards buffers and the fields marked above
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers; // One per thread that recorded; kept after the thread exits
+};
+
+// Records its own lifetime as an event when tracing was enabled at construction
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : name(name), beginNs(0), active(TraceRecorder::instance().isEnabled()) {
+        if (active) {
+            beginNs = TraceRecorder::instance().now();
+        }
+    }
+
+    ~TraceScope() {
+        if (active) {
+            TraceRecorder& recorder = TraceRecorder::instance();
+            recorder.record(name, beginNs, recorder.now());
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    uint64_t beginNs;
+    bool active;
+};
+
+#ifdef RASTERIZER_TRACE
+#define TRACE_SCOPE(name) TraceScope PROFILE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_THREAD_NAME(name) TraceRecorder::instance().setThreadName(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#endif
@@ -0,0 +1,36 @@
+#include "View.h"
+#include <cmath>
+
+// Function to build the view and projection matrices the same way the viewer does for its camera
+View makeView(const Vertex& eye, const Vertex& target, const Vertex& up, const Vertex& lightDirection)
+{
+    Vertex eyePosition = eye;
+    Vertex targetPosition = target;
+    Vertex upDirection = up;
+
+    View view;
+    view.viewMatrix = lookAt(eyePosition, targetPosition, upDirection);
+    view.projection = projectionMatrix(-1.0f / magnitude(eyePosition - targetPosition));
+    view.lightDirection = lightDirection;
+    normalizeVertex(view.lightDirection);
+    return view;
+}
+
+// Function to place the cameras of a turntable, evenly spaced over a full turn
+std::vector<View> makeTurntableViews(const Vertex& eye, const Vertex& target, const Vertex& up, const Vertex& lightDirection,
+    int count)
+{
+    std::vector<View> views;
+    const float Pi = 3.14159265358979f;
+    const float offsetX = eye.x - target.x;
+    const float offsetZ = eye.z - target.z;
+    for (int i = 0; i < count; ++i)
+    {
+        float angle = 2.0f * Pi * i / count;
+        Vertex position = eye;
+        position.x = target.x + offsetX * std::cos(angle) + offsetZ * std::sin(angle);
+        position.z = target.z - offsetX * std::sin(angle) + offsetZ * std::cos(angle);
+        views.push_back(makeView(position, target, up, lightDirection));
+    }
+    return views;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Matrix.h"
+#include "Structs.h"
+#include <vector>
+
+// Camera and light of one rendered view. Passing a View instead of reading the World globals
+// lets frames with different cameras be processed at the same time.
+struct View {
+    Matrix viewMatrix;     // World space to camera space
+    Matrix projection;     // Camera space to clip space
+    Vertex lightDirection; // Direction towards the light in world space, normalized
+};
+
+// Build a view looking from eye at target, lit from the given direction
+View makeView(const Vertex& eye, const Vertex& target, const Vertex& up, const Vertex& lightDirection);
+
+// Build count views on a circle around target, starting at eye and turning about the y axis through target,
+// as a turntable shows a model. The light stays fixed in the world.
+std::vector<View> makeTurntableViews(const Vertex& eye, const Vertex& target, const Vertex& up, const Vertex& lightDirection,
+    int count);
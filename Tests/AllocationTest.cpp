@@ -0,0 +1,146 @@
+#include "DeferredShading.h"
+#include "FramePipeline.h"
+#include "JobSystem.h"
+#include "Model.h"
+#include "Profiler.h"
+#include "RenderCommandBuffer.h"
+#include "Renderer.h"
+#include "Scene.h"
+#include "ShaderProgram.h"
+#include "TiledRenderer.h"
+#include "World.h"
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Steady-state allocation test. Renders a crowd through each rendering path, with the job system on one thread and then
+// on several. A few frames first let every buffer and arena reach its size (the pipeline cycles several frames, each
+// with its own arenas, so the warm-up covers a couple of uses of each); during the frames after them the profiler's
+// allocation counter must not move: transient data comes from frame arenas, jobs from the job system's rings, and
+// everything else keeps its storage between frames.
+// Links the counting operator new of HeapCounter.cpp; skipped if the count doesn't move, as when that is missing.
+// Run from the Rasterizer directory so Model/ is found.
+
+static const int ImageSize = 256;
+static const int WarmUpFrames = 8;
+static const int MeasuredFrames = 5;
+
+// Job system threads of the multithreaded run; more than one even on a single core
+static const int JobThreads = 4;
+
+// Exit code ctest reports as a skipped test
+static const int SkipCode = 77;
+
+// One way of rendering a frame
+struct AllocationPath {
+    const char* name;
+    std::function<void()> renderFrame;
+};
+
+int main()
+{
+    uint64_t probe = Profiler::getHeapAllocationCount();
+    std::unique_ptr<int> allocation(new int(0));
+    if (Profiler::getHeapAllocationCount() == probe)
+    {
+        printf("Allocation counting needs HeapCounter.cpp linked in; skipped\n");
+        return SkipCode;
+    }
+
+    if (!material.loadFromFiles("Model/head.tga", "Model/head_nm.tga", "Model/head_spec.tga"))
+    {
+        printf("Error: run from the Rasterizer directory so Model/ can be found\n");
+        return 2;
+    }
+
+    // The loader reports what it read; keep the test output to the counts
+    std::ostringstream discard;
+    std::streambuf* console = std::cout.rdbuf(discard.rdbuf());
+    Model model("Model/head.obj");
+    std::cout.rdbuf(console);
+
+    Camera = { 0.0f, 0.3f, 2.0f };
+    updateWorld();
+
+    Scene scene;
+    int mesh = scene.addMesh(model);
+    int sceneMaterial = scene.addMaterial(material);
+    for (int i = 0; i < 5; ++i)
+    {
+        scene.addInstance(mesh, sceneMaterial, translationMatrix({ -0.6f + 0.3f * i, 0.0f, -0.3f * (i % 2) }));
+    }
+
+    RenderTarget target(ImageSize, ImageSize);
+    target.setVisibilityEnabled(true);
+    PhongShader shader;
+    RenderCommandBuffer commands;
+    TiledRenderer<PhongShader> tiles;
+    FramePipeline<PhongShader> pipeline(ImageSize, ImageSize, 2, nullptr);
+
+    std::vector<AllocationPath> paths;
+    paths.push_back({ "renderModel", [&] {
+        target.clear({ 0, 0, 0, 255 });
+        renderModel(model, shader, target);
+        target.resolve();
+    } });
+    paths.push_back({ "renderModel/virtual", [&] {
+        target.clear({ 0, 0, 0, 255 });
+        renderModel(model, static_cast<shaderProgram&>(shader), target);
+        target.resolve();
+    } });
+    paths.push_back({ "renderScene", [&] {
+        target.clear({ 0, 0, 0, 255 });
+        renderScene(scene, currentView(), shader, target);
+        target.resolve();
+    } });
+    paths.push_back({ "commands", [&] {
+        commands.clear();
+        commands.recordScene(scene, shader);
+        commands.sort(viewMatrix);
+        target.clear({ 0, 0, 0, 255 });
+        commands.execute(currentView(), target);
+        target.resolve();
+    } });
+    paths.push_back({ "tiled", [&] {
+        target.clear({ 0, 0, 0, 255 });
+        tiles.render(scene, currentView(), shader, target);
+        target.resolve();
+    } });
+    paths.push_back({ "reshade", [&] {
+        reshadeVisibility(commands, currentView(), shader, target);
+    } });
+    paths.push_back({ "pipelined", [&] {
+        pipeline.submit(scene, currentView(), shader, { 0, 0, 0, 255 });
+        pipeline.flush();
+    } });
+
+    // Every path splits its work over the process-wide job system; with several threads the jobs run on its workers
+    int failures = 0;
+    for (int threads : { 1, JobThreads })
+    {
+        JobSystem::instance().configure(threads);
+        for (const AllocationPath& path : paths)
+        {
+            for (int frame = 0; frame < WarmUpFrames; ++frame)
+            {
+                path.renderFrame();
+            }
+
+            uint64_t before = Profiler::getHeapAllocationCount();
+            for (int frame = 0; frame < MeasuredFrames; ++frame)
+            {
+                path.renderFrame();
+            }
+            uint64_t allocations = Profiler::getHeapAllocationCount() - before;
+
+            printf("%-22s %d thread(s)  %llu allocations in %d steady frames  %s\n", path.name, threads,
+                static_cast<unsigned long long>(allocations), MeasuredFrames, allocations == 0 ? "ok" : "FAILED");
+            failures += allocations == 0 ? 0 : 1;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,305 @@
+#include "JobSystem.h"
+#include "Model.h"
+#include "RenderCommandBuffer.h"
+#include "Renderer.h"
+#include "Scene.h"
+#include "ShaderProgram.h"
+#include "TileBinner.h"
+#include "TiledRenderer.h"
+#include "View.h"
+#include "World.h"
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Determinism test. Renders scenes tile by tile with 1 to N threads, several times each, and requires every color,
+// depth and visibility value to be bit-identical to drawing the same sorted commands on one thread. Binning a large
+// triangle set must likewise give the same tile lists on any number of threads, and a batch of turntable views rendered
+// in parallel must match rendering each view on its own. The crowd scene
+// overlaps heads and places one of them twice at the same spot with a 16-bit depth buffer, so depth ties are common
+// and any dependence on thread timing shows up as a different draw id in the visibility attachment.
+// With RASTERIZER_NUMA_NODES=2 the workers are split over two simulated NUMA nodes, each rasterizing its own band.
+// Run from the Rasterizer directory so Model/ is found:
+//
+//     DeterminismTest --max-threads 8 --runs 3
+
+static const int ImageSize = 384;
+
+// One configuration to render at every thread count
+struct DeterminismCase {
+    const char* name;
+    Vertex camera;
+    DepthFormat depthFormat;
+    bool reversedZ;
+    bool crowd;         // Overlapping heads and a coincident duplicate instead of a single head
+};
+
+static const DeterminismCase Cases[] = {
+    { "head/float32", { 1.0f, 0.5f, 1.0f }, DepthFormat::Float32, false, false },
+    { "crowd/float32", { 0.0f, 0.3f, 2.0f }, DepthFormat::Float32, false, true },
+    { "crowd/unorm16", { 0.0f, 0.3f, 2.0f }, DepthFormat::Unorm16, false, true },
+    { "crowd/unorm16-reversed", { 0.5f, 0.0f, 2.0f }, DepthFormat::Unorm16, true, true },
+};
+
+// Everything a render leaves in the target
+struct RenderedFrame {
+    std::vector<uint32_t> color;
+    std::vector<float> depth;
+    std::vector<VisibilitySample> visibility;
+};
+
+// Function to place overlapping heads, the first one twice
+static void layoutScene(Scene& scene, int mesh, int material, bool crowd) {
+    scene.clearInstances();
+    scene.addInstance(mesh, material, Matrix::identity(4));
+    if (!crowd) {
+        return;
+    }
+    scene.addInstance(mesh, material, Matrix::identity(4));
+    for (int i = 0; i < 6; ++i) {
+        Vertex offset = { -0.75f + 0.3f * i, 0.1f * (i % 2), -0.4f * (i % 3) };
+        scene.addInstance(mesh, material, translationMatrix(offset) * rotationYMatrix(0.4f * i));
+    }
+}
+
+// Function to copy the attachments of a resolved target
+static RenderedFrame capture(const RenderTarget& target) {
+    RenderedFrame frame;
+    const size_t pixels = static_cast<size_t>(target.getStride()) * target.getHeight();
+    frame.color.assign(target.getColorData(), target.getColorData() + pixels);
+    frame.visibility.assign(target.getVisibilityData(), target.getVisibilityData() + pixels);
+    for (int y = 0; y < target.getHeight(); ++y) {
+        for (int x = 0; x < target.getWidth(); ++x) {
+            frame.depth.push_back(target.getDepthBuffer().read(y * target.getWidth() + x));
+        }
+    }
+    return frame;
+}
+
+// Function to count the pixels whose color, depth or visible draw differ
+static size_t countDifferences(const RenderedFrame& frame, const RenderedFrame& reference) {
+    size_t differences = 0;
+    for (size_t i = 0; i < reference.color.size(); ++i) {
+        const VisibilitySample& a = frame.visibility[i];
+        const VisibilitySample& b = reference.visibility[i];
+        bool same = frame.color[i] == reference.color[i] && a.draw == b.draw && memcmp(&a.u, &b.u, sizeof(float)) == 0 &&
+            memcmp(&a.v, &b.v, sizeof(float)) == 0;
+        differences += same ? 0 : 1;
+    }
+    for (size_t i = 0; i < reference.depth.size(); ++i) {
+        differences += memcmp(&frame.depth[i], &reference.depth[i], sizeof(float)) == 0 ? 0 : 1;
+    }
+    return differences;
+}
+
+// Function to count the pixels showing one of the coincident instances, where draw order decides the depth ties;
+// reported so a reader can see the crowd cases really exercise ties
+static size_t countCoincidentPixels(const RenderedFrame& frame, const RenderCommandBuffer& commands) {
+    const Matrix identity = Matrix::identity(4);
+    std::vector<bool> coincident(commands.size());
+    for (size_t i = 0; i < commands.size(); ++i) {
+        coincident[i] = memcmp(&commands.getCommand(i).modelMatrix, &identity, sizeof(Matrix)) == 0;
+    }
+
+    size_t count = 0;
+    for (const VisibilitySample& sample : frame.visibility) {
+        count += sample.draw != VisibilitySample::NoDraw && coincident[sample.draw] ? 1 : 0;
+    }
+    return count;
+}
+
+// Function to bin enough scattered triangles that binning itself splits them between threads, and compare every
+// tile's list with binning on one thread; returns the number of thread counts that differ
+static int checkBinning(int maxThreads) {
+    const int width = 1024;
+    const int height = 768;
+    std::vector<BinnedTriangle> triangles(TileBinner::MinTrianglesPerThread * 8);
+    uint32_t seed = 1;
+    for (BinnedTriangle& triangle : triangles) {
+        seed = seed * 1664525u + 1013904223u;
+        int size = 1 + (seed >> 24) % 160;
+        int x = (seed >> 4) % (width - size);
+        int y = (seed >> 12) % (height - size);
+        triangle = BinnedTriangle();
+        triangle.bounds = { x, y, x + size, y + size };
+    }
+
+    JobSystem referenceJobs(1);
+    FrameArena referenceArena;
+    TileBinner reference;
+    reference.bin(triangles.data(), triangles.size(), width, height, referenceJobs, referenceArena);
+
+    int failures = 0;
+    for (int threads = 2; threads <= maxThreads; ++threads) {
+        JobSystem jobs(threads);
+        FrameArena arena;
+        TileBinner binner;
+        binner.bin(triangles.data(), triangles.size(), width, height, jobs, arena);
+        bool same = binner.getEntryCount() == reference.getEntryCount();
+        for (int tile = 0; same && tile < reference.getTileCount(); ++tile) {
+            TileList a = binner.getTile(tile);
+            TileList b = reference.getTile(tile);
+            same = a.count == b.count && memcmp(a.indices, b.indices, sizeof(uint32_t) * a.count) == 0;
+        }
+        if (!same) {
+            printf("%-24s %d thread(s): tile lists differ  FAILED\n", "binning", threads);
+            ++failures;
+        }
+    }
+    printf("%-24s 1..%d threads, %zu entries  %s\n", "binning", maxThreads, reference.getEntryCount(), failures == 0 ? "ok" : "FAILED");
+    return failures;
+}
+
+// Function to render a turntable of the scene as one batch with 1 to N threads and compare every view with renderScene
+// drawing it alone; returns the number of thread counts where some view differs
+static int checkMultiView(const Scene& scene, int maxThreads) {
+    const int ViewCount = 8;
+    const std::vector<View> views = makeTurntableViews({ 0.0f, 0.3f, 2.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f },
+        { 1.0f, 1.0f, 1.0f }, ViewCount);
+    const Color clearColor = { 0, 0, 0, 255 };
+    PhongShader shader;
+
+    std::vector<RenderedFrame> references;
+    RenderTarget single(ImageSize, ImageSize);
+    single.setVisibilityEnabled(true);
+    for (const View& view : views) {
+        PhongShader viewShader = shader;
+        single.clear(clearColor);
+        renderScene(scene, view, viewShader, single);
+        single.resolve();
+        references.push_back(capture(single));
+    }
+
+    std::vector<RenderTarget> targets;
+    for (int i = 0; i < ViewCount; ++i) {
+        targets.emplace_back(ImageSize, ImageSize);
+        targets.back().setVisibilityEnabled(true);
+    }
+    int failures = 0;
+    for (int threads = 1; threads <= maxThreads; ++threads) {
+        JobSystem jobs(threads);
+        renderViews(scene, views, shader, clearColor, targets, jobs);
+        size_t differences = 0;
+        for (int i = 0; i < ViewCount; ++i) {
+            differences += countDifferences(capture(targets[i]), references[i]);
+        }
+        if (differences != 0) {
+            printf("%-24s %d thread(s): %zu values differ  FAILED\n", "multi-view", threads, differences);
+            ++failures;
+        }
+    }
+
+    // A batch short of a target must be refused rather than leave a view out
+    targets.pop_back();
+    bool refused = false;
+    try {
+        renderViews(scene, views, shader, clearColor, targets);
+    } catch (const std::invalid_argument&) {
+        refused = true;
+    }
+    if (!refused) {
+        printf("%-24s %d views into %d targets not refused  FAILED\n", "multi-view", ViewCount, ViewCount - 1);
+        ++failures;
+    }
+    printf("%-24s %d views, 1..%d threads  %s\n", "multi-view", ViewCount, maxThreads, failures == 0 ? "ok" : "FAILED");
+    return failures;
+}
+
+int main(int argc, char** argv)
+{
+    int maxThreads = 8;
+    int runs = 3;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--max-threads") == 0 && i + 1 < argc)
+        {
+            maxThreads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc)
+        {
+            runs = atoi(argv[++i]);
+        }
+        else
+        {
+            printf("Error: unknown argument %s\n", argv[i]);
+            printf("Usage: %s [--max-threads n] [--runs n]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (!material.loadFromFiles("Model/head.tga", "Model/head_nm.tga", "Model/head_spec.tga"))
+    {
+        printf("Error: run from the Rasterizer directory so Model/ can be found\n");
+        return 2;
+    }
+
+    // The loader reports what it read; keep the test output to the comparisons
+    std::ostringstream discard;
+    std::streambuf* console = std::cout.rdbuf(discard.rdbuf());
+    Model model("Model/head.obj");
+    std::cout.rdbuf(console);
+
+    Scene scene;
+    int mesh = scene.addMesh(model);
+    int sceneMaterial = scene.addMaterial(material);
+
+    int failures = checkBinning(maxThreads);
+    for (const DeterminismCase& test : Cases)
+    {
+        layoutScene(scene, mesh, sceneMaterial, test.crowd);
+        Camera = test.camera;
+        lightDirection = { 1.0f, 1.0f, 1.0f };
+        updateWorld();
+
+        RenderTarget target(ImageSize, ImageSize, test.depthFormat, test.reversedZ);
+        target.setVisibilityEnabled(true);
+        PhongShader shader;
+
+        // Reference: the sorted commands drawn one after another on this thread
+        RenderCommandBuffer commands;
+        commands.recordScene(scene, shader);
+        commands.sort(viewMatrix);
+        target.clear({ 0, 0, 0, 255 });
+        commands.execute(currentView(), target);
+        target.resolve();
+        RenderedFrame reference = capture(target);
+        if (test.crowd)
+        {
+            printf("%-24s %zu pixels decided by draw order between coincident instances\n", test.name,
+                countCoincidentPixels(reference, commands));
+        }
+
+        int caseFailures = 0;
+        for (int threads = 1; threads <= maxThreads; ++threads)
+        {
+            JobSystem jobs(threads);
+            TiledRenderer<PhongShader> tiles;
+            tiles.setJobSystem(jobs);
+            for (int run = 0; run < runs; ++run)
+            {
+                target.clear({ 0, 0, 0, 255 });
+                tiles.render(scene, currentView(), shader, target);
+                target.resolve();
+                size_t differences = countDifferences(capture(target), reference);
+                if (differences != 0)
+                {
+                    printf("%-24s %d thread(s), run %d: %zu values differ  FAILED\n", test.name, threads, run + 1, differences);
+                    ++caseFailures;
+                }
+            }
+        }
+        printf("%-24s 1..%d threads x %d runs  %s\n", test.name, maxThreads, runs, caseFailures == 0 ? "ok" : "FAILED");
+        failures += caseFailures;
+    }
+
+    layoutScene(scene, mesh, sceneMaterial, true);
+    failures += checkMultiView(scene, maxThreads);
+
+    printf("%d mismatching renders\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,294 @@
+#include "DeferredShading.h"
+#include "FramePipeline.h"
+#include "ImageCompare.h"
+#include "Model.h"
+#include "RenderCommandBuffer.h"
+#include "Renderer.h"
+#include "Scene.h"
+#include "ShaderProgram.h"
+#include "World.h"
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+// Golden-image regression test. Renders head.obj from a fixed set of camera and light placements through every
+// rendering path and compares each image with the stored reference of its placement. Reference images are produced
+// by the plain renderModel path with reference math; other paths must stay within their path's tolerance.
+// Run from the Rasterizer directory so Model/ is found:
+//
+//     GoldenImageTest --references ../Tests/Golden --output golden-out
+//     GoldenImageTest --references ../Tests/Golden --update      (after an intended change to the output)
+//
+// Failing comparisons write the rendered image and a heat map of the perceptual error to the output directory.
+
+static const int ImageSize = 512;
+
+// Camera and light of one reference image
+struct GoldenView {
+    const char* name;
+    Vertex camera;
+    Vertex light;
+};
+
+static const GoldenView Views[] = {
+    { "front", { 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f, 1.0f } },
+    { "oblique", { 1.0f, 0.5f, 1.0f }, { 1.0f, 1.0f, 1.0f } },
+    { "profile", { 1.0f, 0.0f, 0.1f }, { -1.0f, 0.2f, 0.5f } },
+    { "above", { 0.0f, 1.5f, 1.0f }, { 0.5f, 1.0f, 0.0f } },
+    { "far", { 0.0f, 0.0f, 3.0f }, { 0.0f, 0.0f, 1.0f } },
+};
+
+// Everything a rendering path needs; the camera globals are already set for the view
+struct GoldenContext {
+    const Model& model;
+    Scene& scene;
+};
+
+// One way of producing the image, with how close it must come to the reference
+struct RenderPath {
+    const char* name;
+    std::function<void(GoldenContext&, RenderTarget&)> render;
+    ImageTolerance tolerance;
+};
+
+// Paths that must shade exactly like the reference; the slack only absorbs compiler and -march differences
+// (contracted multiply-adds move a few edge pixels)
+static const ImageTolerance ExactTolerance = { 8, 0.0005, 40.0, 0.05, 0.0005 };
+
+// Approximate math: small shading differences everywhere, nothing a viewer would notice
+static const ImageTolerance FastMathTolerance = { 8, 0.02, 34.0, 0.5, 0.01 };
+
+// Reduced depth precision may flip nearly coplanar surfaces
+static const ImageTolerance DepthTolerance = { 8, 0.002, 36.0, 0.1, 0.002 };
+
+// Function to render the way the viewer's immediate path does, through the specialized raster loop
+static void renderReference(GoldenContext& context, RenderTarget& target) {
+    PhongShader shader;
+    target.clear({ 0, 0, 0, 255 });
+    renderModel(context.model, shader, target);
+    target.resolve();
+}
+
+static std::vector<RenderPath> makePaths() {
+    std::vector<RenderPath> paths;
+
+    paths.push_back({ "reference", renderReference, ExactTolerance });
+
+    paths.push_back({ "virtual", [](GoldenContext& context, RenderTarget& target) {
+        PhongShader shader;
+        target.clear({ 0, 0, 0, 255 });
+        renderModel(context.model, static_cast<shaderProgram&>(shader), target);
+        target.resolve();
+    }, ExactTolerance });
+
+    paths.push_back({ "fastmath", [](GoldenContext& context, RenderTarget& target) {
+        PhongShader shader;
+        shader.quality = ShaderQuality::Fast;
+        target.clear({ 0, 0, 0, 255 });
+        renderModel(context.model, shader, target);
+        target.resolve();
+    }, FastMathTolerance });
+
+    paths.push_back({ "unorm24", [](GoldenContext& context, RenderTarget& target) {
+        PhongShader shader;
+        target.getDepthBuffer().configure(DepthFormat::Unorm24, false);
+        target.clear({ 0, 0, 0, 255 });
+        renderModel(context.model, shader, target);
+        target.resolve();
+    }, DepthTolerance });
+
+    paths.push_back({ "unorm16-reversed", [](GoldenContext& context, RenderTarget& target) {
+        PhongShader shader;
+        target.getDepthBuffer().configure(DepthFormat::Unorm16, true);
+        target.clear({ 0, 0, 0, 255 });
+        renderModel(context.model, shader, target);
+        target.resolve();
+    }, DepthTolerance });
+
+    paths.push_back({ "commands", [](GoldenContext& context, RenderTarget& target) {
+        PhongShader shader;
+        RenderCommandBuffer commands;
+        commands.recordScene(context.scene, shader);
+        commands.sort(viewMatrix);
+        target.clear({ 0, 0, 0, 255 });
+        commands.execute(currentView(), target);
+        target.resolve();
+    }, ExactTolerance });
+
+    paths.push_back({ "pipelined", [](GoldenContext& context, RenderTarget& target) {
+        PhongShader shader;
+        FramePipeline<PhongShader> pipeline(target.getWidth(), target.getHeight(), 2, [&target](const RenderTarget& frame, uint64_t) {
+            // Targets don't copy, so take the resolved frame pixel by pixel
+            target.clear({ 0, 0, 0, 255 });
+            target.prepare(0, 0, target.getWidth() - 1, target.getHeight() - 1);
+            for (int y = 0; y < target.getHeight(); ++y) {
+                for (int x = 0; x < target.getWidth(); ++x) {
+                    uint32_t pixel = frame.getPixel(y * frame.getStride() + x);
+                    Color color = { static_cast<uint8_t>(pixel >> 16), static_cast<uint8_t>(pixel >> 8),
+                        static_cast<uint8_t>(pixel), static_cast<uint8_t>(pixel >> 24) };
+                    target.setPixel(y * target.getStride() + x, color);
+                }
+            }
+        });
+        pipeline.submit(context.scene, currentView(), shader, { 0, 0, 0, 255 });
+        pipeline.flush();
+    }, ExactTolerance });
+
+    paths.push_back({ "reshaded", [](GoldenContext& context, RenderTarget& target) {
+        // Render under a different light, then re-shade the visible surfaces with the view's light
+        PhongShader shader;
+        RenderCommandBuffer commands;
+        commands.recordScene(context.scene, shader);
+        commands.sort(viewMatrix);
+        target.setVisibilityEnabled(true);
+        View view = currentView();
+        View otherLight = view;
+        otherLight.lightDirection = { -view.lightDirection.x, view.lightDirection.y, view.lightDirection.z };
+        target.clear({ 0, 0, 0, 255 });
+        commands.execute(otherLight, target);
+        target.resolve();
+        reshadeVisibility(commands, view, shader, target);
+    }, ExactTolerance });
+
+    return paths;
+}
+
+// Everything the command line selects
+struct GoldenOptions {
+    std::string referenceDir;
+    std::string outputDir;
+    std::string filter;
+    bool update;
+};
+
+static bool parseOptions(int argc, char** argv, GoldenOptions& options) {
+    options.referenceDir = "../Tests/Golden";
+    options.outputDir = ".";
+    options.update = false;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--references") == 0 && hasValue) {
+            options.referenceDir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--output") == 0 && hasValue) {
+            options.outputDir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+            options.filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--update") == 0) {
+            options.update = true;
+        }
+        else {
+            printf("Error: unknown argument %s\n", argv[i]);
+            printf("Usage: %s [--references dir] [--output dir] [--filter text] [--update]\n", argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Function to point the camera and light globals at a view
+static void applyView(const GoldenView& view) {
+    Camera = view.camera;
+    lightDirection = view.light;
+    updateWorld();
+}
+
+int main(int argc, char** argv)
+{
+    GoldenOptions options;
+    if (!parseOptions(argc, argv, options))
+    {
+        return 2;
+    }
+
+    if (!material.loadFromFiles("Model/head.tga", "Model/head_nm.tga", "Model/head_spec.tga"))
+    {
+        printf("Error: run from the Rasterizer directory so Model/ can be found\n");
+        return 2;
+    }
+
+    // The loader reports what it read; keep the test output to the comparisons
+    std::ostringstream discard;
+    std::streambuf* console = std::cout.rdbuf(discard.rdbuf());
+    Model model("Model/head.obj");
+    std::cout.rdbuf(console);
+
+    Scene scene;
+    scene.addInstance(scene.addMesh(model), scene.addMaterial(material), Matrix::identity(4));
+    GoldenContext context = { model, scene };
+
+    if (options.update)
+    {
+        // References always come from the reference path
+        for (const GoldenView& view : Views)
+        {
+            applyView(view);
+            RenderTarget target(ImageSize, ImageSize);
+            renderReference(context, target);
+            std::string file = options.referenceDir + "/" + view.name + ".tga";
+            if (!saveImage(file, captureTarget(target)))
+            {
+                printf("Error: can't write %s\n", file.c_str());
+                return 1;
+            }
+            printf("Updated %s\n", file.c_str());
+        }
+        return 0;
+    }
+
+    std::vector<RenderPath> paths = makePaths();
+    int failures = 0;
+    int comparisons = 0;
+    printf("%-28s %9s %10s %8s %10s %10s  %s\n", "Image", "Max delta", "Differing", "PSNR", "Mean dE", "Visible", "Result");
+    for (const GoldenView& view : Views)
+    {
+        RgbImage reference;
+        std::string referenceFile = options.referenceDir + "/" + view.name + ".tga";
+        if (!loadImage(referenceFile, reference) || reference.width != ImageSize || reference.height != ImageSize)
+        {
+            printf("Error: missing or wrong-sized reference %s; run with --update to create it\n", referenceFile.c_str());
+            ++failures;
+            continue;
+        }
+
+        for (const RenderPath& path : paths)
+        {
+            std::string name = std::string(view.name) + "/" + path.name;
+            if (!options.filter.empty() && name.find(options.filter) == std::string::npos)
+            {
+                continue;
+            }
+
+            applyView(view);
+            RenderTarget target(ImageSize, ImageSize);
+            path.render(context, target);
+
+            RgbImage image = captureTarget(target);
+            RgbImage heatMap;
+            ImageDifference difference = compareImages(image, reference, path.tolerance.channelTolerance, &heatMap);
+            bool passed = withinTolerance(difference, path.tolerance);
+            ++comparisons;
+
+            printf("%-28s %9d %9.4f%% %8.2f %10.4f %9.4f%%  %s\n", name.c_str(), difference.maxChannelDelta,
+                difference.differingFraction * 100.0, difference.psnr, difference.meanDeltaE, difference.perceptibleFraction * 100.0,
+                passed ? "ok" : "FAILED");
+
+            if (!passed)
+            {
+                ++failures;
+                std::string prefix = options.outputDir + "/" + view.name + "_" + path.name;
+                saveImage(prefix + ".tga", image);
+                saveImage(prefix + "_diff.tga", heatMap);
+                printf("    wrote %s.tga and %s_diff.tga\n", prefix.c_str(), prefix.c_str());
+            }
+        }
+    }
+
+    printf("%d of %d comparisons failed\n", failures, comparisons);
+    return failures == 0 ? 0 : 1;
+}
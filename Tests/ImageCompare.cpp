@@ -0,0 +1,186 @@
+#include "ImageCompare.h"
+#include "TGAImage.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Function to copy the packed ARGB pixels of a target into RGB bytes
+RgbImage captureTarget(const RenderTarget& target) {
+    RgbImage image;
+    image.width = target.getWidth();
+    image.height = target.getHeight();
+    image.pixels.resize(static_cast<size_t>(image.width) * image.height * 3);
+    for (int y = 0; y < image.height; ++y) {
+        const uint32_t* row = target.getColorData() + static_cast<size_t>(y) * target.getStride();
+        for (int x = 0; x < image.width; ++x) {
+            uint8_t* out = &image.pixels[(static_cast<size_t>(y) * image.width + x) * 3];
+            out[0] = (row[x] >> 16) & 0xFF;
+            out[1] = (row[x] >> 8) & 0xFF;
+            out[2] = row[x] & 0xFF;
+        }
+    }
+    return image;
+}
+
+// Function to read a TGA file of any depth the loader supports
+bool loadImage(const std::string& filename, RgbImage& image) {
+    TGAImage file;
+    if (!file.read_tga_file(filename.c_str())) {
+        return false;
+    }
+
+    image.width = file.get_width();
+    image.height = file.get_height();
+    image.pixels.resize(static_cast<size_t>(image.width) * image.height * 3);
+    for (int y = 0; y < image.height; ++y) {
+        for (int x = 0; x < image.width; ++x) {
+            TGAColor color = file.get(x, y);
+            uint8_t* out = &image.pixels[(static_cast<size_t>(y) * image.width + x) * 3];
+            if (file.get_bytespp() == TGAImage::GRAYSCALE) {
+                out[0] = out[1] = out[2] = color.raw[0];
+            }
+            else {
+                out[0] = color.r;
+                out[1] = color.g;
+                out[2] = color.b;
+            }
+        }
+    }
+    return true;
+}
+
+bool saveImage(const std::string& filename, const RgbImage& image) {
+    TGAImage file(image.width, image.height, TGAImage::RGB);
+    for (int y = 0; y < image.height; ++y) {
+        for (int x = 0; x < image.width; ++x) {
+            const uint8_t* in = &image.pixels[(static_cast<size_t>(y) * image.width + x) * 3];
+            file.set(x, y, TGAColor(in[0], in[1], in[2], 255));
+        }
+    }
+    return file.write_tga_file(filename.c_str());
+}
+
+// Function to convert an sRGB byte to linear light
+static float toLinear(uint8_t value) {
+    float c = value / 255.0f;
+    return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+// Function to convert an sRGB pixel to CIELAB (D65 white)
+static void toLab(const uint8_t* rgb, float lab[3]) {
+    float r = toLinear(rgb[0]);
+    float g = toLinear(rgb[1]);
+    float b = toLinear(rgb[2]);
+    float xyz[3] = {
+        (0.4124f * r + 0.3576f * g + 0.1805f * b) / 0.9505f,
+        0.2126f * r + 0.7152f * g + 0.0722f * b,
+        (0.0193f * r + 0.1192f * g + 0.9505f * b) / 1.0890f
+    };
+    for (float& t : xyz) {
+        t = t > 0.008856f ? std::cbrt(t) : 7.787f * t + 16.0f / 116.0f;
+    }
+    lab[0] = 116.0f * xyz[1] - 16.0f;
+    lab[1] = 500.0f * (xyz[0] - xyz[1]);
+    lab[2] = 200.0f * (xyz[1] - xyz[2]);
+}
+
+// Function to convert an image to CIELAB and average each pixel with its 3x3 neighbourhood. Like the spatial filter
+// of FLIP, this hides single-pixel noise the eye cannot resolve while keeping edges and shading changes visible.
+static std::vector<float> filteredLab(const RgbImage& image) {
+    const int width = image.width;
+    const int height = image.height;
+    std::vector<float> lab(static_cast<size_t>(width) * height * 3);
+    for (size_t i = 0; i < lab.size() / 3; ++i) {
+        toLab(&image.pixels[i * 3], &lab[i * 3]);
+    }
+
+    std::vector<float> filtered(lab.size());
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float sum[3] = { 0.0f, 0.0f, 0.0f };
+            int count = 0;
+            for (int ny = std::max(0, y - 1); ny <= std::min(height - 1, y + 1); ++ny) {
+                for (int nx = std::max(0, x - 1); nx <= std::min(width - 1, x + 1); ++nx) {
+                    const float* in = &lab[(static_cast<size_t>(ny) * width + nx) * 3];
+                    sum[0] += in[0];
+                    sum[1] += in[1];
+                    sum[2] += in[2];
+                    ++count;
+                }
+            }
+            float* out = &filtered[(static_cast<size_t>(y) * width + x) * 3];
+            out[0] = sum[0] / count;
+            out[1] = sum[1] / count;
+            out[2] = sum[2] / count;
+        }
+    }
+    return filtered;
+}
+
+// Function to measure every difference between an image and its reference
+ImageDifference compareImages(const RgbImage& image, const RgbImage& reference, int channelTolerance, RgbImage* heatMap) {
+    // Color difference a viewer can just notice side by side
+    const float noticeableDeltaE = 2.3f;
+    // Difference shown at full brightness in the heat map
+    const float heatMapScale = 20.0f;
+
+    ImageDifference difference;
+    const size_t pixelCount = static_cast<size_t>(image.width) * image.height;
+
+    int maxDelta = 0;
+    size_t differing = 0;
+    double squaredError = 0.0;
+    for (size_t i = 0; i < pixelCount; ++i) {
+        int pixelDelta = 0;
+        for (int channel = 0; channel < 3; ++channel) {
+            int delta = std::abs(image.pixels[i * 3 + channel] - reference.pixels[i * 3 + channel]);
+            pixelDelta = std::max(pixelDelta, delta);
+            squaredError += static_cast<double>(delta) * delta;
+        }
+        maxDelta = std::max(maxDelta, pixelDelta);
+        if (pixelDelta > channelTolerance) {
+            ++differing;
+        }
+    }
+    difference.maxChannelDelta = maxDelta;
+    difference.differingFraction = static_cast<double>(differing) / pixelCount;
+
+    double meanSquaredError = squaredError / (pixelCount * 3.0);
+    difference.psnr = meanSquaredError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError)
+                                             : std::numeric_limits<double>::infinity();
+
+    std::vector<float> imageLab = filteredLab(image);
+    std::vector<float> referenceLab = filteredLab(reference);
+    if (heatMap) {
+        heatMap->width = image.width;
+        heatMap->height = image.height;
+        heatMap->pixels.assign(pixelCount * 3, 0);
+    }
+
+    double deltaESum = 0.0;
+    size_t perceptible = 0;
+    for (size_t i = 0; i < pixelCount; ++i) {
+        float dl = imageLab[i * 3] - referenceLab[i * 3];
+        float da = imageLab[i * 3 + 1] - referenceLab[i * 3 + 1];
+        float db = imageLab[i * 3 + 2] - referenceLab[i * 3 + 2];
+        float deltaE = std::sqrt(dl * dl + da * da + db * db);
+        deltaESum += deltaE;
+        if (deltaE > noticeableDeltaE) {
+            ++perceptible;
+        }
+
+        if (heatMap) {
+            float heat = std::min(1.0f, deltaE / heatMapScale);
+            heatMap->pixels[i * 3] = static_cast<uint8_t>(255.0f * std::min(1.0f, heat * 2.0f));
+            heatMap->pixels[i * 3 + 1] = static_cast<uint8_t>(255.0f * std::max(0.0f, heat * 2.0f - 1.0f));
+        }
+    }
+    difference.meanDeltaE = deltaESum / pixelCount;
+    difference.perceptibleFraction = static_cast<double>(perceptible) / pixelCount;
+    return difference;
+}
+
+bool withinTolerance(const ImageDifference& difference, const ImageTolerance& tolerance) {
+    return difference.differingFraction <= tolerance.maxDifferingFraction && difference.psnr >= tolerance.minPsnr &&
+        difference.meanDeltaE <= tolerance.maxMeanDeltaE && difference.perceptibleFraction <= tolerance.maxPerceptibleFraction;
+}
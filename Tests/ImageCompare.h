@@ -0,0 +1,47 @@
+#pragma once
+
+#include "RenderTarget.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 8-bit RGB image, rows top to bottom
+struct RgbImage {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels; // width * height * 3 bytes, R G B
+};
+
+// How far a rendered image is from its reference
+struct ImageDifference {
+    int maxChannelDelta;        // Largest difference of one channel
+    double differingFraction;   // Pixels with a channel off by more than the tolerance, over all pixels
+    double psnr;                // Peak signal-to-noise ratio over all channels in dB; infinite when identical
+    double meanDeltaE;          // Mean CIELAB color difference after filtering, a FLIP-style perceptual error
+    double perceptibleFraction; // Pixels whose filtered difference is above the just-noticeable threshold
+};
+
+// Limits an image must stay within to match its reference
+struct ImageTolerance {
+    int channelTolerance;          // Channel deltas up to this are not counted as differing
+    double maxDifferingFraction;
+    double minPsnr;
+    double maxMeanDeltaE;
+    double maxPerceptibleFraction;
+};
+
+// Copy the resolved color attachment of a target
+RgbImage captureTarget(const RenderTarget& target);
+
+// Read a TGA file; false if it can't be read
+bool loadImage(const std::string& filename, RgbImage& image);
+
+// Write an RGB TGA file; false if it can't be written
+bool saveImage(const std::string& filename, const RgbImage& image);
+
+// Compare two images of the same size. When heatMap is given it receives the perceptual error per pixel:
+// black where nothing is visible, through red to yellow for the largest differences.
+ImageDifference compareImages(const RgbImage& image, const RgbImage& reference, int channelTolerance, RgbImage* heatMap);
+
+// True when every measure is within its limit
+bool withinTolerance(const ImageDifference& difference, const ImageTolerance& tolerance);
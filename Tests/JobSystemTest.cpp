@@ -0,0 +1,176 @@
+#include "JobSystem.h"
+#include <atomic>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// Job system test. On job systems of 1 to N threads, parallelFor must call its body on ranges no longer than the
+// grain that cover every index exactly once, also when the body itself runs a parallelFor, and waiting on a parent
+// job must wait for every child and grandchild created under it, also when more jobs are queued than a thread's ring
+// holds, and jobs queued for a NUMA node must all run, also when they queue more work of their own. Set RASTERIZER_NUMA_NODES to split the workers over simulated nodes.
+//
+//     JobSystemTest --max-threads 8
+
+// Function to run parallelFor over several counts and grains and count how often each index was visited;
+// returns the number of runs where some index was visited other than once or a range exceeded the grain
+static int checkParallelFor(JobSystem& jobs) {
+    const size_t counts[] = { 0, 1, 7, 1000, 100003 };
+    const size_t grains[] = { 1, 16, 4096 };
+    int failures = 0;
+    for (size_t count : counts) {
+        for (size_t grain : grains) {
+            std::unique_ptr<std::atomic<int>[]> visits(new std::atomic<int>[count + 1]);
+            for (size_t i = 0; i < count; ++i) {
+                visits[i] = 0;
+            }
+            std::atomic<int> oversized(0);
+            jobs.parallelFor(count, grain, [&visits, &oversized, grain](size_t begin, size_t end) {
+                if (end - begin > grain || begin >= end) {
+                    oversized++;
+                }
+                for (size_t i = begin; i < end; ++i) {
+                    visits[i]++;
+                }
+            });
+
+            size_t wrong = 0;
+            for (size_t i = 0; i < count; ++i) {
+                wrong += visits[i] == 1 ? 0 : 1;
+            }
+            if (wrong != 0 || oversized != 0) {
+                printf("%-24s %d thread(s), count %zu, grain %zu: %zu indices wrong, %d bad ranges  FAILED\n",
+                    "parallelFor", jobs.getThreadCount(), count, grain, wrong, oversized.load());
+                ++failures;
+            }
+        }
+    }
+    return failures;
+}
+
+// Function to run a parallelFor from inside every range of another and count the inner iterations
+static int checkNestedParallelFor(JobSystem& jobs) {
+    const size_t Outer = 64;
+    const size_t Inner = 1000;
+    std::atomic<size_t> total(0);
+    jobs.parallelFor(Outer, 1, [&jobs, &total](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            jobs.parallelFor(Inner, 10, [&total](size_t innerBegin, size_t innerEnd) {
+                total += innerEnd - innerBegin;
+            });
+        }
+    });
+    if (total != Outer * Inner) {
+        printf("%-24s %d thread(s): %zu of %zu iterations  FAILED\n", "nested parallelFor", jobs.getThreadCount(),
+            total.load(), Outer * Inner);
+        return 1;
+    }
+    return 0;
+}
+
+// Function to build a tree of jobs, part of it created by running jobs, and check waiting on the root waits for all
+static int checkDependencies(JobSystem& jobs) {
+    const int Children = 100;
+    const int GrandChildren = 10;
+    std::atomic<int> finished(0);
+    Job* root = jobs.createGroup();
+    Job* subtree = jobs.createGroup(root);
+    for (int child = 0; child < Children; ++child) {
+        // Each child adds jobs to the subtree while it runs; the subtree can't finish first, since the child is in it
+        jobs.run(jobs.create([&jobs, &finished, subtree] {
+            for (int grandChild = 0; grandChild < GrandChildren; ++grandChild) {
+                jobs.run(jobs.create([&finished] { finished++; }, subtree));
+            }
+            finished++;
+        }, subtree));
+    }
+    jobs.run(subtree);
+    jobs.run(root);
+    jobs.wait(root);
+
+    const int expected = Children * (1 + GrandChildren);
+    if (finished != expected) {
+        printf("%-24s %d thread(s): %d of %d jobs finished before the wait returned  FAILED\n", "dependencies",
+            jobs.getThreadCount(), finished.load(), expected);
+        return 1;
+    }
+    return 0;
+}
+
+// Function to queue more jobs than a thread's ring holds before waiting on any, and check they all ran. The ring fills
+// with jobs that are queued but not run, so creating the next one has to run some of them first.
+static int checkFullRing(JobSystem& jobs) {
+    const int JobCount = 3 * JobSystem::PoolSize;
+    std::atomic<int> finished(0);
+    Job* group = jobs.createGroup();
+    for (int i = 0; i < JobCount; ++i) {
+        jobs.run(jobs.create([&finished] { finished++; }, group));
+    }
+    jobs.run(group);
+    jobs.wait(group);
+
+    if (finished != JobCount) {
+        printf("%-24s %d thread(s): %d of %d jobs finished before the wait returned  FAILED\n", "full ring",
+            jobs.getThreadCount(), finished.load(), JobCount);
+        return 1;
+    }
+    return 0;
+}
+
+// Function to queue parallelFor jobs for every node and check each one ran in full before the wait returned
+static int checkNodeJobs(JobSystem& jobs) {
+    const size_t PerNode = 10000;
+    const int Rounds = 16;
+    std::atomic<size_t> total(0);
+    Job* group = jobs.createGroup();
+    for (int round = 0; round < Rounds; ++round) {
+        for (int node = 0; node < jobs.getNodeCount(); ++node) {
+            jobs.run(jobs.create([&jobs, &total] {
+                jobs.parallelFor(PerNode, 100, [&total](size_t begin, size_t end) {
+                    total += end - begin;
+                });
+            }, group), node);
+        }
+    }
+    jobs.run(group);
+    jobs.wait(group);
+
+    const size_t expected = PerNode * Rounds * jobs.getNodeCount();
+    if (total != expected) {
+        printf("%-24s %d thread(s), %d node(s): %zu of %zu iterations  FAILED\n", "node jobs", jobs.getThreadCount(),
+            jobs.getNodeCount(), total.load(), expected);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    int maxThreads = 8;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--max-threads") == 0 && i + 1 < argc)
+        {
+            maxThreads = atoi(argv[++i]);
+        }
+        else
+        {
+            printf("Error: unknown argument %s\n", argv[i]);
+            printf("Usage: %s [--max-threads n]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    int failures = 0;
+    for (int threads = 1; threads <= maxThreads; ++threads)
+    {
+        JobSystem jobs(threads);
+        int threadFailures = checkParallelFor(jobs) + checkNestedParallelFor(jobs) + checkDependencies(jobs) +
+            checkFullRing(jobs) + checkNodeJobs(jobs);
+        printf("%-24s %d thread(s), %d node(s)  %s\n", "job system", threads, jobs.getNodeCount(),
+            threadFailures == 0 ? "ok" : "FAILED");
+        failures += threadFailures;
+    }
+    return failures == 0 ? 0 : 1;
+}